@@ -5,6 +5,7 @@
 
 #include <libtrap/trap.h>
 #include <unirec/unirec.h>
+#include <ur_view.h>
 
 #include "blacklist.h"
 #include "fields.h"
@@ -14,6 +15,12 @@ UR_FIELDS (
     uint16 DST_PORT,
 )
 
+#define FILTER_VIEW_FIELDS(F, V) \
+    F(V, SCALAR, ip_addr_t, UR_TYPE_IP, DST_IP, UR_VIEW_REQUIRED) \
+    F(V, SCALAR, uint16_t, UR_TYPE_UINT16, DST_PORT, UR_VIEW_REQUIRED)
+
+UR_VIEW_DEFINE(filter_view, FILTER_VIEW_FIELDS)
+
 #define MODULE_BASIC_INFO(BASIC) \
     BASIC("miner_filter", "Miner blacklist filter.\n", 1, 2)
 
@@ -32,6 +39,8 @@ do_mainloop(Blacklist& blacklist)
     uint16_t data_size;
     const void *data;
     ur_template_t *tmplt;
+    filter_view_t view;
+    const char *missing;
 
     tmplt = ur_create_input_template(0, "DST_IP,DST_PORT", NULL);
     if (tmplt == NULL) {
@@ -39,6 +48,13 @@ do_mainloop(Blacklist& blacklist)
         return 1;
     }
 
+    missing = filter_view_resolve(&view, tmplt);
+    if (missing != nullptr) {
+        std::cerr << "Error: Field " << missing << " could not be resolved." << std::endl;
+        ur_free_template(tmplt);
+        return 1;
+    }
+
     trap_set_required_fmt(0, TRAP_FMT_UNIREC, "");
 
     while (!stop) {
@@ -59,6 +75,18 @@ do_mainloop(Blacklist& blacklist)
             }
 
             tmplt = ur_define_fields_and_update_template(spec, tmplt);
+            if (tmplt == NULL) {
+                std::cerr << "Error: Template could not be updated." << std::endl;
+                return 1;
+            }
+
+            // Offsets are resolved once per format, records are then read by plain pointer arithmetic
+            missing = filter_view_resolve(&view, tmplt);
+            if (missing != nullptr) {
+                std::cerr << "Error: Field " << missing << " is not present in input format." << std::endl;
+                ur_free_template(tmplt);
+                return 1;
+            }
 
             // Set the same data format to repeaters output interface
             trap_set_data_fmt(0, TRAP_FMT_UNIREC, spec);
@@ -66,8 +94,8 @@ do_mainloop(Blacklist& blacklist)
         }
 
         struct filter_pair filter_pair(
-            *static_cast<ip_addr_t*>(ur_get_ptr(tmplt, data, F_DST_IP)),
-            *static_cast<uint16_t*>(ur_get_ptr(tmplt, data, F_DST_PORT)));
+            filter_view_DST_IP(&view, data),
+            filter_view_DST_PORT(&view, data));
 
         if (blacklist.is_blacklisted(filter_pair) == true) {
             ret = trap_send(0, data, data_size);
@@ -0,0 +1,184 @@
+/*!
+ * \file ur_view.h
+ * \brief Typed views of UniRec records with offsets resolved per template
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _UR_VIEW_H_
+#define _UR_VIEW_H_
+
+/*
+ * Header-only layer shared by NEMEA modules of the pipeline (usable from C
+ * and C++). A view is generated from a field schema: an X-macro listing
+ * fields the module reads. Offsets of all fields are resolved once after
+ * every TRAP_E_FORMAT_CHANGED into a flat structure, so reading a field in
+ * the hot path is a single load relative to the record.
+ *
+ * Schema macro takes the generator F and the view name V:
+ *
+ *    #define MY_FIELDS(F, V) \
+ *       F(V, SCALAR, ip_addr_t, UR_TYPE_IP, DST_IP, UR_VIEW_REQUIRED) \
+ *       F(V, ARRAY, double, UR_TYPE_A_DOUBLE, PREDICTED_PROBAS, UR_VIEW_OPTIONAL)
+ *
+ *    UR_VIEW_DEFINE(my_view, MY_FIELDS)
+ *
+ * defines type my_view_t and functions
+ *
+ *    const char *my_view_resolve(my_view_t *v, const ur_template_t *tmplt);
+ *    int my_view_has_DST_IP(const my_view_t *v);
+ *    ip_addr_t my_view_DST_IP(const my_view_t *v, const void *rec);
+ *    const double *my_view_PREDICTED_PROBAS(const my_view_t *v, const void *rec, uint16_t *cnt);
+ *
+ * Resolve returns NULL on success or the name of the first required field
+ * that is missing or has unexpected type. Optional fields that are missing
+ * have to be tested by _has_ before reading.
+ *
+ * Fields whose names are known only at run time (e.g. given on command line)
+ * are resolved by ur_view_resolve_name() and read by ur_view_array().
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <unirec/unirec.h>
+
+#define UR_VIEW_REQUIRED 1 /*< Resolve fails if field is missing. */
+#define UR_VIEW_OPTIONAL 0 /*< Field may be missing. */
+
+#define UR_VIEW_NO_FIELD (-1) /*< Offset of missing field. */
+
+/* Generators applied to every field of schema. */
+#define UR_VIEW_MEMBER_(V, KIND, CTYPE, URTYPE, NAME, REQ) \
+   int16_t NAME;
+
+#define UR_VIEW_RESOLVE_(V, KIND, CTYPE, URTYPE, NAME, REQ) \
+   id = ur_get_id_by_name(#NAME); \
+   if (id >= 0 && ur_is_present(tmplt, id) && ur_get_type(id) == (URTYPE)) { \
+      v->NAME = tmplt->offset[id]; \
+   } else if (REQ) { \
+      return #NAME; \
+   } else { \
+      v->NAME = UR_VIEW_NO_FIELD; \
+   }
+
+#define UR_VIEW_GETTER_(V, KIND, CTYPE, URTYPE, NAME, REQ) \
+   static inline int V##_has_##NAME(const V##_t *v) \
+   { \
+      return v->NAME != UR_VIEW_NO_FIELD; \
+   } \
+   UR_VIEW_GETTER_##KIND(V, CTYPE, NAME)
+
+#define UR_VIEW_GETTER_SCALAR(V, CTYPE, NAME) \
+   static inline CTYPE V##_##NAME(const V##_t *v, const void *rec) \
+   { \
+      CTYPE val; \
+      memcpy(&val, (const char *)rec + v->NAME, sizeof(val)); \
+      return val; \
+   } \
+   static inline const void *V##_##NAME##_ptr(const V##_t *v, const void *rec) \
+   { \
+      return (const char *)rec + v->NAME; \
+   }
+
+/*
+ * Array getter returns pointer into the record, which is not necessarily
+ * aligned to CTYPE (records and variable fields start at arbitrary offsets),
+ * elements have to be read by memcpy() or unaligned loads.
+ */
+#define UR_VIEW_GETTER_ARRAY(V, CTYPE, NAME) \
+   static inline const CTYPE *V##_##NAME(const V##_t *v, const void *rec, uint16_t *cnt) \
+   { \
+      uint16_t hdr[2]; /* offset from end of static part, length in bytes */ \
+      memcpy(hdr, (const char *)rec + v->NAME, sizeof(hdr)); \
+      *cnt = hdr[1] / sizeof(CTYPE); \
+      return (const CTYPE *)((const char *)rec + v->static_size + hdr[0]); \
+   }
+
+/*!
+ * \brief Resolve offset of field given by name.
+ * \param[in] tmplt Template.
+ * \param[in] name Name of field.
+ * \param[in] type Expected UniRec type of field.
+ * \return Offset of field or UR_VIEW_NO_FIELD if it is missing or has other type.
+ */
+static inline int16_t ur_view_resolve_name(const ur_template_t *tmplt, const char *name, int type)
+{
+   int id = ur_get_id_by_name(name);
+   if (id >= 0 && ur_is_present(tmplt, id) && ur_get_type(id) == type) {
+      return tmplt->offset[id];
+   }
+   return UR_VIEW_NO_FIELD;
+}
+
+/*!
+ * \brief Read array field resolved by ur_view_resolve_name().
+ * \param[in] rec Record.
+ * \param[in] static_size Size of static part of records of template.
+ * \param[in] offset Offset of field.
+ * \param[out] size Size of array in bytes.
+ * \return Pointer to the first element, not necessarily aligned.
+ */
+static inline const void *ur_view_array(const void *rec, uint16_t static_size, int16_t offset, uint16_t *size)
+{
+   uint16_t hdr[2]; /* offset from end of static part, length in bytes */
+   memcpy(hdr, (const char *)rec + offset, sizeof(hdr));
+   *size = hdr[1];
+   return (const char *)rec + static_size + hdr[0];
+}
+
+/*!
+ * \brief Define view type and accessors from field schema.
+ * \param V Name of the view.
+ * \param FIELDS Schema macro, see top of this file.
+ */
+#define UR_VIEW_DEFINE(V, FIELDS) \
+   typedef struct V##_s { \
+      uint16_t static_size; \
+      FIELDS(UR_VIEW_MEMBER_, V) \
+   } V##_t; \
+   static inline const char *V##_resolve(V##_t *v, const ur_template_t *tmplt) \
+   { \
+      int id; \
+      v->static_size = tmplt->static_size; \
+      FIELDS(UR_VIEW_RESOLVE_, V) \
+      (void)id; \
+      return NULL; \
+   } \
+   FIELDS(UR_VIEW_GETTER_, V)
+
+#endif /* _UR_VIEW_H_ */
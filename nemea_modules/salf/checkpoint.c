@@ -0,0 +1,212 @@
+/*!
+ * \file checkpoint.c
+ * \brief Persistent state of adaptive strategies
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*!
+ * \brief Read valid records of existing state file.
+ * \param[in,out] ckpt State file with open fd.
+ * \param[in] path File name.
+ */
+static void salf_ckpt_read_old(salf_ckpt_t *ckpt, const char *path)
+{
+   salf_ckpt_hdr_t hdr;
+   size_t size;
+   size_t i;
+
+   if (pread(ckpt->fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr)) {
+      return;
+   }
+   if (hdr.magic != SALF_CKPT_MAGIC || hdr.version < 1 || hdr.version > SALF_CKPT_VERSION || hdr.shards == 0) {
+      fprintf(stderr, "Warning: %s is not a SALF state file, starting without saved state.\n", path);
+      return;
+   }
+   if (hdr.nout != ckpt->nout) {
+      fprintf(stderr, "Warning: %s holds state of %u strategies, %zu configured, starting without saved state.\n", path, hdr.nout, ckpt->nout);
+      return;
+   }
+   size = (size_t)hdr.shards * hdr.nout * sizeof(salf_ckpt_rec_t);
+   ckpt->old = malloc(size);
+   if (ckpt->old == NULL) {
+      return;
+   }
+   if (pread(ckpt->fd, ckpt->old, size, sizeof(hdr)) != (ssize_t)size) {
+      free(ckpt->old);
+      ckpt->old = NULL;
+      return;
+   }
+   if (hdr.version < 2) {
+      // layout 1 has no PI controller state, records have the same size
+      for (i = 0; i < (size_t)hdr.shards * hdr.nout; i++) {
+         ckpt->old[i].rate = 0;
+         ckpt->old[i].integral = 0;
+      }
+   }
+   ckpt->old_shards = hdr.shards;
+}
+
+int salf_ckpt_open(salf_ckpt_t *ckpt, const char *path, size_t shards, size_t nout)
+{
+   salf_ckpt_hdr_t *hdr;
+
+   memset(ckpt, 0, sizeof(*ckpt));
+   ckpt->nout = nout;
+   ckpt->shards = shards;
+   ckpt->fd = open(path, O_RDWR | O_CREAT, 0644);
+   if (ckpt->fd < 0) {
+      fprintf(stderr, "Error: Could not open state file %s.\n", path);
+      return 1;
+   }
+   salf_ckpt_read_old(ckpt, path);
+
+   ckpt->size = sizeof(salf_ckpt_hdr_t) + shards * nout * sizeof(salf_ckpt_rec_t);
+   if (ftruncate(ckpt->fd, (off_t)ckpt->size) != 0) {
+      fprintf(stderr, "Error: Could not resize state file %s.\n", path);
+      salf_ckpt_close(ckpt);
+      return 1;
+   }
+   ckpt->map = mmap(NULL, ckpt->size, PROT_READ | PROT_WRITE, MAP_SHARED, ckpt->fd, 0);
+   if (ckpt->map == MAP_FAILED) {
+      ckpt->map = NULL;
+      fprintf(stderr, "Error: Could not map state file %s.\n", path);
+      salf_ckpt_close(ckpt);
+      return 1;
+   }
+   hdr = ckpt->map;
+   ckpt->rec = (salf_ckpt_rec_t *)(hdr + 1);
+   memset(ckpt->rec, 0, shards * nout * sizeof(salf_ckpt_rec_t));
+   memset(hdr, 0, sizeof(*hdr));
+   hdr->magic = SALF_CKPT_MAGIC;
+   hdr->version = SALF_CKPT_VERSION;
+   hdr->nout = (uint32_t)nout;
+   hdr->shards = (uint32_t)shards;
+   return 0;
+}
+
+size_t salf_ckpt_attach(salf_ckpt_t *ckpt, salf_strategy_set_t *set, size_t shard)
+{
+   size_t i, k;
+   size_t restored = 0;
+
+   set->ckpt = ckpt->rec + shard * ckpt->nout;
+   for (k = 0; k < set->cnt && ckpt->old != NULL; k++) {
+      salf_strategy_t *s = &set->strategy[k];
+      double threshold = 0;
+      double u = 0;
+      int64_t t = 0;
+      double rate = 0;
+      double integral = 0;
+      size_t n = 0;
+
+      if (ckpt->old_shards == ckpt->shards) {
+         const salf_ckpt_rec_t *rec = &ckpt->old[shard * ckpt->nout + k];
+         if (rec->valid && rec->query_strategy == s->params.query_strategy) {
+            threshold = rec->threshold;
+            u = rec->u;
+            t = rec->t;
+            rate = rec->rate;
+            integral = rec->integral;
+            n = 1;
+         }
+      } else {
+         for (i = 0; i < ckpt->old_shards; i++) {
+            const salf_ckpt_rec_t *rec = &ckpt->old[i * ckpt->nout + k];
+            if (rec->valid && rec->query_strategy == s->params.query_strategy) {
+               threshold += rec->threshold;
+               u += rec->u;
+               t += rec->t;
+               rate += rec->rate;
+               integral += rec->integral;
+               n++;
+            }
+         }
+         if (n > 0) {
+            // budget counters of the whole stream are split among new shards
+            threshold /= (double)n;
+            rate /= (double)n;
+            integral /= (double)n;
+            u /= (double)ckpt->shards;
+            t /= (int64_t)ckpt->shards;
+         }
+      }
+      if (n > 0) {
+         s->state.threshold = threshold;
+         s->state.u = u;
+         s->state.t = (long)t;
+         s->state.rate = rate;
+         s->state.integral = integral;
+         if (t > 0) {
+            // decisions are not saved, window is refilled with the saved fraction
+            uint32_t len = t > UINT32_MAX ? UINT32_MAX : (uint32_t)t;
+            salf_window_fill(&s->state.window, len, (uint32_t)(u / (double)t * len + 0.5));
+         }
+         restored++;
+      }
+      salf_ckpt_save(&set->ckpt[k], s);
+   }
+   for (; k < set->cnt; k++) {
+      salf_ckpt_save(&set->ckpt[k], &set->strategy[k]);
+   }
+   return restored;
+}
+
+void salf_ckpt_close(salf_ckpt_t *ckpt)
+{
+   if (ckpt->map != NULL) {
+      msync(ckpt->map, ckpt->size, MS_SYNC);
+      munmap(ckpt->map, ckpt->size);
+      ckpt->map = NULL;
+   }
+   if (ckpt->fd >= 0) {
+      close(ckpt->fd);
+      ckpt->fd = -1;
+   }
+   free(ckpt->old);
+   ckpt->old = NULL;
+}
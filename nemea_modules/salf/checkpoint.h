@@ -0,0 +1,153 @@
+/*!
+ * \file checkpoint.h
+ * \brief Persistent state of adaptive strategies
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "strategy.h"
+
+/*
+ * State of every strategy instance is mirrored into a shared file mapping
+ * after each decided batch. Stores go to the page cache only, the file is
+ * written back by the kernel (and synced at exit), so the hot path pays a
+ * few stores per batch. A crashed or restarted module finds the last state
+ * in the file and continues with the adapted threshold and budget counters
+ * instead of starting from threshold 1.0.
+ *
+ * The file consists of a header followed by shards * nout records, shard
+ * is the thread running the instances (0 without workers, worker number
+ * otherwise). Records are cache line sized, so workers never share a line.
+ */
+
+#define SALF_CKPT_MAGIC 0x5453464c41534c53ULL /*< "SLSALFST" */
+#define SALF_CKPT_VERSION 2 /*< Version of file layout, files of version 1 (without PI controller state) are read too. */
+
+/*!
+ * \brief Header of state file.
+ */
+typedef struct salf_ckpt_hdr_s {
+   uint64_t magic; /*< SALF_CKPT_MAGIC. */
+   uint32_t version; /*< SALF_CKPT_VERSION. */
+   uint32_t nout; /*< Number of strategy instances per shard. */
+   uint32_t shards; /*< Number of shards. */
+   uint32_t reserved; /*< Zero. */
+   char pad[40]; /*< Padding to cache line. */
+} salf_ckpt_hdr_t;
+
+/*!
+ * \brief Saved state of one strategy instance.
+ */
+typedef struct salf_ckpt_rec_s {
+   int32_t query_strategy; /*< ID of strategy the state belongs to. */
+   int32_t valid; /*< Record was written. */
+   double threshold; /*< Labeling threshold. */
+   double u; /*< Number of labeled flows. */
+   int64_t t; /*< Number of seen flows. */
+   double rate; /*< Averaged label rate (PI controller). */
+   double integral; /*< Integral term (PI controller). */
+   char pad[16]; /*< Padding to cache line. */
+} salf_ckpt_rec_t;
+
+/*!
+ * \brief Opened state file.
+ */
+typedef struct salf_ckpt_s {
+   int fd; /*< File descriptor. */
+   void *map; /*< Mapping of the whole file. */
+   size_t size; /*< Size of mapping. */
+   salf_ckpt_rec_t *rec; /*< Records, shards * nout. */
+   size_t nout; /*< Number of strategy instances per shard. */
+   size_t shards; /*< Number of shards. */
+   salf_ckpt_rec_t *old; /*< Records found in file at open, NULL if none. */
+   size_t old_shards; /*< Number of shards of old records. */
+} salf_ckpt_t;
+
+/*!
+ * \brief Open (or create) state file and map it.
+ * Valid state found in file is kept for salf_ckpt_attach(), the file is
+ * then resized to the given layout.
+ * \param[out] ckpt State file.
+ * \param[in] path File name.
+ * \param[in] shards Number of shards.
+ * \param[in] nout Number of strategy instances per shard.
+ * \return 0 on success, 1 on error (message is printed).
+ */
+int salf_ckpt_open(salf_ckpt_t *ckpt, const char *path, size_t shards, size_t nout);
+
+/*!
+ * \brief Restore state of set from file and bind set to its records.
+ * State of instance k is restored from record of the same shard when the
+ * number of shards did not change, otherwise counters of all old shards of
+ * instance k are merged and split evenly. Records of a different strategy
+ * are ignored.
+ * \param[in] ckpt State file.
+ * \param[in,out] set Strategy set with nout instances.
+ * \param[in] shard Shard of set.
+ * \return Number of restored instances.
+ */
+size_t salf_ckpt_attach(salf_ckpt_t *ckpt, salf_strategy_set_t *set, size_t shard);
+
+/*!
+ * \brief Write mapping back to file and close it.
+ * \param[in] ckpt State file.
+ */
+void salf_ckpt_close(salf_ckpt_t *ckpt);
+
+/*!
+ * \brief Save state of instance.
+ * \param[out] rec Record.
+ * \param[in] s Instance.
+ */
+static inline void salf_ckpt_save(salf_ckpt_rec_t *rec, const salf_strategy_t *s)
+{
+   rec->threshold = s->state.threshold;
+   rec->u = s->state.u;
+   rec->t = s->state.t;
+   rec->rate = s->state.rate;
+   rec->integral = s->state.integral;
+   rec->query_strategy = s->params.query_strategy;
+   rec->valid = 1;
+}
+
+#endif /* _CHECKPOINT_H_ */
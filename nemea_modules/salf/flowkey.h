@@ -0,0 +1,160 @@
+/*!
+ * \file flowkey.h
+ * \brief Hash of flow key (src/dst IP, ports, protocol)
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _FLOWKEY_H_
+#define _FLOWKEY_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "salf.h"
+#include "xxhash.h"
+
+/*
+ * Flow key is a concatenation of the selected fields of record. The source
+ * endpoint (SRC_IP, SRC_PORT) and the destination endpoint (DST_IP,
+ * DST_PORT) are ordered, unless the key is one-way, so both directions of a
+ * session have the same key. Fields missing in the template are left out.
+ * The key is hashed by XXH3 with a fixed seed, the hash of a flow is the
+ * same in every instance and across restarts.
+ */
+
+#define SALF_KEY_SRC_IP 1 /*< Key contains SRC_IP. */
+#define SALF_KEY_DST_IP 2 /*< Key contains DST_IP. */
+#define SALF_KEY_SRC_PORT 4 /*< Key contains SRC_PORT. */
+#define SALF_KEY_DST_PORT 8 /*< Key contains DST_PORT. */
+#define SALF_KEY_PROTOCOL 16 /*< Key contains PROTOCOL. */
+#define SALF_KEY_DEFAULT 31 /*< Key contains all fields. */
+#define SALF_KEY_SIZE (2 * (sizeof(ip_addr_t) + sizeof(uint16_t)) + sizeof(uint8_t)) /*< Max size of key. */
+#define SALF_KEY_SEED 0x53414c46ULL /*< Seed of key hash. */
+
+/*!
+ * \brief Serialize endpoint of flow.
+ * \param[out] buf Buffer.
+ * \param[in] ip Pointer to IP address field, NULL if not in key.
+ * \param[in] port Pointer to port field, NULL if not in key.
+ * \return Size of endpoint.
+ */
+static inline size_t salf_flowkey_endpoint(uint8_t *buf, const void *ip, const void *port)
+{
+   size_t len = 0;
+
+   if (ip != NULL) {
+      memcpy(buf, ip, sizeof(ip_addr_t));
+      len += sizeof(ip_addr_t);
+   }
+   if (port != NULL) {
+      memcpy(buf + len, port, sizeof(uint16_t));
+      len += sizeof(uint16_t);
+   }
+   return len;
+}
+
+/*!
+ * \brief Fields of key present in format.
+ * \param[in] view View of records with resolved offsets.
+ * \param[in] mask Fields of key, SALF_KEY_* flags.
+ * \return Fields of mask which the format contains, 0 if all records share one key.
+ */
+static inline unsigned int salf_flowkey_fields(const salf_view_t *view, unsigned int mask)
+{
+   unsigned int present = 0;
+
+   present |= salf_view_has_SRC_IP(view) ? SALF_KEY_SRC_IP : 0;
+   present |= salf_view_has_DST_IP(view) ? SALF_KEY_DST_IP : 0;
+   present |= salf_view_has_SRC_PORT(view) ? SALF_KEY_SRC_PORT : 0;
+   present |= salf_view_has_DST_PORT(view) ? SALF_KEY_DST_PORT : 0;
+   present |= salf_view_has_PROTOCOL(view) ? SALF_KEY_PROTOCOL : 0;
+   return present & mask;
+}
+
+/*!
+ * \brief Build flow key of record.
+ * \param[out] buf Buffer of SALF_KEY_SIZE bytes.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in] mask Fields of key, SALF_KEY_* flags.
+ * \param[in] oneway Do not order endpoints (directions of session differ).
+ * \return Size of key.
+ */
+static inline size_t salf_flowkey(uint8_t *buf, const void *data, const salf_view_t *view, unsigned int mask, int oneway)
+{
+   uint8_t dst[sizeof(ip_addr_t) + sizeof(uint16_t)];
+   size_t src_len, dst_len;
+   size_t len;
+
+   src_len = salf_flowkey_endpoint(buf,
+      (mask & SALF_KEY_SRC_IP) && salf_view_has_SRC_IP(view) ? salf_view_SRC_IP_ptr(view, data) : NULL,
+      (mask & SALF_KEY_SRC_PORT) && salf_view_has_SRC_PORT(view) ? salf_view_SRC_PORT_ptr(view, data) : NULL);
+   dst_len = salf_flowkey_endpoint(dst,
+      (mask & SALF_KEY_DST_IP) && salf_view_has_DST_IP(view) ? salf_view_DST_IP_ptr(view, data) : NULL,
+      (mask & SALF_KEY_DST_PORT) && salf_view_has_DST_PORT(view) ? salf_view_DST_PORT_ptr(view, data) : NULL);
+   if (!oneway && src_len == dst_len && memcmp(buf, dst, src_len) > 0) {
+      // lower endpoint first
+      memmove(buf + dst_len, buf, src_len);
+      memcpy(buf, dst, dst_len);
+   } else {
+      memcpy(buf + src_len, dst, dst_len);
+   }
+   len = src_len + dst_len;
+   if ((mask & SALF_KEY_PROTOCOL) && salf_view_has_PROTOCOL(view)) {
+      buf[len++] = salf_view_PROTOCOL(view, data);
+   }
+   return len;
+}
+
+/*!
+ * \brief Hash of flow key of record.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in] mask Fields of key, SALF_KEY_* flags.
+ * \param[in] oneway Do not order endpoints.
+ * \return 64-bit hash.
+ */
+static inline uint64_t salf_flowhash(const void *data, const salf_view_t *view, unsigned int mask, int oneway)
+{
+   uint8_t buf[SALF_KEY_SIZE];
+   size_t len = salf_flowkey(buf, data, view, mask, oneway);
+
+   return XXH3_64bits_withSeed(buf, len, SALF_KEY_SEED);
+}
+
+#endif /* _FLOWKEY_H_ */
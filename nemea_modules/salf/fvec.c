@@ -0,0 +1,248 @@
+/*!
+ * \file fvec.c
+ * \brief Float32 kernels over feature vectors
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#include "fvec.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FVEC_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Every kernel accumulates acc[j] += planes[f * 64 + j] * x[f] for f in
+ * ascending order with separate multiply and add (no FMA), so each lane
+ * performs the same rounding as the scalar loop and all kernels return
+ * bit-identical signatures. Distance kernels accumulate (c - x)^2 in the
+ * same way, one lane per point. GCC would contract multiply and add into FMA
+ * where the target has it (AVX-512, -march=native), which is disabled per
+ * function.
+ */
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define FVEC_NO_FMA __attribute__((optimize("fp-contract=off")))
+#else
+#define FVEC_NO_FMA
+#endif
+
+fvec_simhash_fnc_t fvec_simhash = &fvec_simhash_scalar;
+fvec_dist2_fnc_t fvec_dist2 = &fvec_dist2_scalar;
+
+FVEC_NO_FMA
+uint64_t fvec_simhash_scalar(const float *planes, const float *x, size_t n)
+{
+   float acc[FVEC_SIMHASH_BITS] = {0};
+   uint64_t sig = 0;
+   size_t f, j;
+
+   for (f = 0; f < n; f++) {
+      for (j = 0; j < FVEC_SIMHASH_BITS; j++) {
+         acc[j] += planes[f * FVEC_SIMHASH_BITS + j] * x[f];
+      }
+   }
+   for (j = 0; j < FVEC_SIMHASH_BITS; j++) {
+      sig |= (uint64_t)(acc[j] > 0) << j;
+   }
+   return sig;
+}
+
+FVEC_NO_FMA
+void fvec_dist2_scalar(const float *c, size_t stride, size_t m, const float *x, size_t n, float *dist)
+{
+   size_t f, j;
+
+   for (j = 0; j < m; j++) {
+      dist[j] = 0;
+   }
+   for (f = 0; f < n; f++) {
+      for (j = 0; j < m; j++) {
+         float d = c[f * stride + j] - x[f];
+         dist[j] += d * d;
+      }
+   }
+}
+
+#ifdef FVEC_X86
+
+__attribute__((target("sse2"))) FVEC_NO_FMA
+static uint64_t fvec_simhash_sse2(const float *planes, const float *x, size_t n)
+{
+   __m128 acc[FVEC_SIMHASH_BITS / 4];
+   __m128 zero = _mm_setzero_ps();
+   uint64_t sig = 0;
+   size_t f, j;
+
+   for (j = 0; j < FVEC_SIMHASH_BITS / 4; j++) {
+      acc[j] = zero;
+   }
+   for (f = 0; f < n; f++) {
+      __m128 xf = _mm_set1_ps(x[f]);
+      const float *row = planes + f * FVEC_SIMHASH_BITS;
+      for (j = 0; j < FVEC_SIMHASH_BITS / 4; j++) {
+         acc[j] = _mm_add_ps(acc[j], _mm_mul_ps(_mm_loadu_ps(row + 4 * j), xf));
+      }
+   }
+   for (j = 0; j < FVEC_SIMHASH_BITS / 4; j++) {
+      sig |= (uint64_t)_mm_movemask_ps(_mm_cmpgt_ps(acc[j], zero)) << (4 * j);
+   }
+   return sig;
+}
+
+__attribute__((target("sse2"))) FVEC_NO_FMA
+static void fvec_dist2_sse2(const float *c, size_t stride, size_t m, const float *x, size_t n, float *dist)
+{
+   size_t f, j;
+
+   for (j = 0; j < m; j += 4) {
+      __m128 acc = _mm_setzero_ps();
+      for (f = 0; f < n; f++) {
+         __m128 d = _mm_sub_ps(_mm_loadu_ps(c + f * stride + j), _mm_set1_ps(x[f]));
+         acc = _mm_add_ps(acc, _mm_mul_ps(d, d));
+      }
+      _mm_storeu_ps(dist + j, acc);
+   }
+}
+
+__attribute__((target("avx2"))) FVEC_NO_FMA
+static uint64_t fvec_simhash_avx2(const float *planes, const float *x, size_t n)
+{
+   __m256 acc[FVEC_SIMHASH_BITS / 8];
+   __m256 zero = _mm256_setzero_ps();
+   uint64_t sig = 0;
+   size_t f, j;
+
+   for (j = 0; j < FVEC_SIMHASH_BITS / 8; j++) {
+      acc[j] = zero;
+   }
+   for (f = 0; f < n; f++) {
+      __m256 xf = _mm256_set1_ps(x[f]);
+      const float *row = planes + f * FVEC_SIMHASH_BITS;
+      for (j = 0; j < FVEC_SIMHASH_BITS / 8; j++) {
+         acc[j] = _mm256_add_ps(acc[j], _mm256_mul_ps(_mm256_loadu_ps(row + 8 * j), xf));
+      }
+   }
+   for (j = 0; j < FVEC_SIMHASH_BITS / 8; j++) {
+      sig |= (uint64_t)_mm256_movemask_ps(_mm256_cmp_ps(acc[j], zero, _CMP_GT_OQ)) << (8 * j);
+   }
+   return sig;
+}
+
+__attribute__((target("avx2"))) FVEC_NO_FMA
+static void fvec_dist2_avx2(const float *c, size_t stride, size_t m, const float *x, size_t n, float *dist)
+{
+   size_t f, j;
+
+   for (j = 0; j < m; j += 8) {
+      __m256 acc = _mm256_setzero_ps();
+      for (f = 0; f < n; f++) {
+         __m256 d = _mm256_sub_ps(_mm256_loadu_ps(c + f * stride + j), _mm256_set1_ps(x[f]));
+         acc = _mm256_add_ps(acc, _mm256_mul_ps(d, d));
+      }
+      _mm256_storeu_ps(dist + j, acc);
+   }
+}
+
+__attribute__((target("avx512f"))) FVEC_NO_FMA
+static uint64_t fvec_simhash_avx512(const float *planes, const float *x, size_t n)
+{
+   __m512 acc[FVEC_SIMHASH_BITS / 16];
+   __m512 zero = _mm512_setzero_ps();
+   uint64_t sig = 0;
+   size_t f, j;
+
+   for (j = 0; j < FVEC_SIMHASH_BITS / 16; j++) {
+      acc[j] = zero;
+   }
+   for (f = 0; f < n; f++) {
+      __m512 xf = _mm512_set1_ps(x[f]);
+      const float *row = planes + f * FVEC_SIMHASH_BITS;
+      for (j = 0; j < FVEC_SIMHASH_BITS / 16; j++) {
+         acc[j] = _mm512_add_ps(acc[j], _mm512_mul_ps(_mm512_loadu_ps(row + 16 * j), xf));
+      }
+   }
+   for (j = 0; j < FVEC_SIMHASH_BITS / 16; j++) {
+      sig |= (uint64_t)_mm512_cmp_ps_mask(acc[j], zero, _CMP_GT_OQ) << (16 * j);
+   }
+   return sig;
+}
+
+__attribute__((target("avx512f"))) FVEC_NO_FMA
+static void fvec_dist2_avx512(const float *c, size_t stride, size_t m, const float *x, size_t n, float *dist)
+{
+   size_t f, j;
+
+   for (j = 0; j < m; j += 16) {
+      __m512 acc = _mm512_setzero_ps();
+      for (f = 0; f < n; f++) {
+         __m512 d = _mm512_sub_ps(_mm512_loadu_ps(c + f * stride + j), _mm512_set1_ps(x[f]));
+         acc = _mm512_add_ps(acc, _mm512_mul_ps(d, d));
+      }
+      _mm512_storeu_ps(dist + j, acc);
+   }
+}
+
+#endif /* FVEC_X86 */
+
+const char *fvec_init(void)
+{
+#ifdef FVEC_X86
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx512f")) {
+      fvec_simhash = &fvec_simhash_avx512;
+      fvec_dist2 = &fvec_dist2_avx512;
+      return "avx512";
+   }
+   if (__builtin_cpu_supports("avx2")) {
+      fvec_simhash = &fvec_simhash_avx2;
+      fvec_dist2 = &fvec_dist2_avx2;
+      return "avx2";
+   }
+   if (__builtin_cpu_supports("sse2")) {
+      fvec_simhash = &fvec_simhash_sse2;
+      fvec_dist2 = &fvec_dist2_sse2;
+      return "sse2";
+   }
+#endif
+   fvec_simhash = &fvec_simhash_scalar;
+   fvec_dist2 = &fvec_dist2_scalar;
+   return "scalar";
+}
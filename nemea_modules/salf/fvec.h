@@ -0,0 +1,134 @@
+/*!
+ * \file fvec.h
+ * \brief Float32 kernels over feature vectors
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+
+#ifndef _FVEC_H_
+#define _FVEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define FVEC_SIMHASH_BITS 64 /*< Number of bits of SimHash signature. */
+#define FVEC_LANES 16 /*< Number of points of distance kernels has to be a multiple of this. */
+
+/*!
+ * \brief SimHash kernel type.
+ * Projects x[0..n-1] on 64 hyperplanes, planes[f * 64 + j] is the f-th
+ * coordinate of the normal of hyperplane j. Bit j of the result is set if
+ * the dot product with normal j is positive.
+ */
+typedef uint64_t (*fvec_simhash_fnc_t)(const float *planes, const float *x, size_t n);
+
+/*!
+ * \brief Squared distance kernel type.
+ * Computes dist[j] = sum((c[f * stride + j] - x[f])^2) for j < m, points
+ * are stored by features (c[f * stride + j] is feature f of point j), m is
+ * a multiple of FVEC_LANES.
+ */
+typedef void (*fvec_dist2_fnc_t)(const float *c, size_t stride, size_t m, const float *x, size_t n, float *dist);
+
+/*!
+ * \brief SimHash kernel selected by fvec_init().
+ * All kernels return bit-identical results.
+ */
+extern fvec_simhash_fnc_t fvec_simhash;
+
+/*!
+ * \brief Squared distance kernel selected by fvec_init().
+ * All kernels return bit-identical results.
+ */
+extern fvec_dist2_fnc_t fvec_dist2;
+
+/*!
+ * \brief Select the best kernels for the host CPU.
+ * Scalar kernels are used until this function is called and on CPUs
+ * without SIMD support.
+ * \return Name of selected kernel set ("scalar", "sse2", "avx2" or "avx512").
+ */
+const char *fvec_init(void);
+
+/*!
+ * \brief Scalar SimHash kernel.
+ * \param[in] planes Normals of hyperplanes, n rows of 64 floats.
+ * \param[in] x Feature vector.
+ * \param[in] n Number of features.
+ * \return Signature.
+ */
+uint64_t fvec_simhash_scalar(const float *planes, const float *x, size_t n);
+
+/*!
+ * \brief Scalar squared distance kernel.
+ * \param[in] c Points, n rows of stride floats.
+ * \param[in] stride Number of floats in row of points.
+ * \param[in] m Number of points (multiple of FVEC_LANES).
+ * \param[in] x Feature vector.
+ * \param[in] n Number of features.
+ * \param[out] dist Squared distances of x to points, m floats.
+ */
+void fvec_dist2_scalar(const float *c, size_t stride, size_t m, const float *x, size_t n, float *dist);
+
+/*!
+ * \brief Compress dynamic range of feature value.
+ * Returns sign(v) * log2(1 + |v|) approximated by the exponent and the
+ * linearly interpolated mantissa of 1 + |v| (error below 0.09), so byte and
+ * packet counts, durations and ratios get comparable scales.
+ * \param[in] v Value.
+ * \return Compressed value.
+ */
+static inline float fvec_log2(double v)
+{
+   union {
+      float f;
+      uint32_t u;
+   } b;
+   float a = (float)(v < 0 ? 1 - v : 1 + v);
+   float l;
+
+   if (!(a < 3.4e38f)) {
+      return 0; // NaN and overflow carry no information
+   }
+   b.f = a;
+   l = (float)((int)(b.u >> 23) - 127) + (float)(b.u & 0x7fffff) * (1.0f / 8388608.0f);
+   return v < 0 ? -l : l;
+}
+
+#endif /* _FVEC_H_ */
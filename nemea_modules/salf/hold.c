@@ -0,0 +1,238 @@
+/*!
+ * \file hold.c
+ * \brief Records held by windowed strategies
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "hold.h"
+
+int salf_hold_reserve(salf_hold_t *h, size_t cap)
+{
+   salf_hold_rec_t *rec;
+   size_t i;
+
+   if (cap == h->cap) {
+      return 0;
+   }
+   for (i = cap; i < h->cap; i++) {
+      free(h->rec[i].data);
+   }
+   if (h->cnt > cap) {
+      // prefix of heap is a heap
+      h->cnt = cap;
+   }
+   if (cap == 0) {
+      free(h->rec);
+      h->rec = NULL;
+      h->cnt = 0;
+      h->cap = 0;
+      return 0;
+   }
+   rec = realloc(h->rec, cap * sizeof(*rec));
+   if (rec == NULL) {
+      if (cap < h->cap) {
+         // slots beyond cap were freed, keep them unused
+         h->cap = cap;
+      }
+      return 1;
+   }
+   for (i = h->cap; i < cap; i++) {
+      memset(&rec[i], 0, sizeof(rec[i]));
+   }
+   h->rec = rec;
+   h->cap = cap;
+   return 0;
+}
+
+void salf_hold_free(salf_hold_t *h)
+{
+   salf_hold_reserve(h, 0);
+   h->seen = 0;
+}
+
+int salf_hold_copy(salf_hold_rec_t *r, const void *data, uint16_t size, double key)
+{
+   if (r->alloc < size) {
+      char *p = realloc(r->data, size);
+      if (p == NULL) {
+         return 1;
+      }
+      r->data = p;
+      r->alloc = size;
+   }
+   memcpy(r->data, data, size);
+   r->size = size;
+   r->key = key;
+   return 0;
+}
+
+/*!
+ * \brief Move slot i down to restore order of max-heap.
+ * \param[in,out] h Held records.
+ * \param[in] i Slot.
+ */
+static void salf_hold_sift_down(salf_hold_t *h, size_t i)
+{
+   salf_hold_rec_t tmp = h->rec[i];
+
+   for (;;) {
+      size_t c = 2 * i + 1;
+      if (c >= h->cnt) {
+         break;
+      }
+      if (c + 1 < h->cnt && h->rec[c + 1].key > h->rec[c].key) {
+         c++;
+      }
+      if (!(h->rec[c].key > tmp.key)) {
+         break;
+      }
+      h->rec[i] = h->rec[c];
+      i = c;
+   }
+   h->rec[i] = tmp;
+}
+
+void salf_hold_heap_offer(salf_hold_t *h, const void *data, uint16_t size, double key)
+{
+   size_t i;
+   salf_hold_rec_t tmp;
+
+   if (h->cnt < h->cap) {
+      i = h->cnt;
+      if (salf_hold_copy(&h->rec[i], data, size, key)) {
+         return;
+      }
+      h->cnt++;
+      // sift up
+      tmp = h->rec[i];
+      while (i > 0 && h->rec[(i - 1) / 2].key < tmp.key) {
+         h->rec[i] = h->rec[(i - 1) / 2];
+         i = (i - 1) / 2;
+      }
+      h->rec[i] = tmp;
+      return;
+   }
+   if (h->cnt == 0 || !(key < h->rec[0].key)) {
+      return;
+   }
+   if (salf_hold_copy(&h->rec[0], data, size, key) == 0) {
+      salf_hold_sift_down(h, 0);
+   }
+}
+
+void salf_hold_heap_trim(salf_hold_t *h, size_t cnt)
+{
+   while (h->cnt > cnt) {
+      // move root to the end, its buffer stays allocated in the unused slot
+      salf_hold_rec_t tmp = h->rec[0];
+      h->cnt--;
+      h->rec[0] = h->rec[h->cnt];
+      h->rec[h->cnt] = tmp;
+      salf_hold_sift_down(h, 0);
+   }
+}
+
+size_t salf_hold_release(salf_hold_t *h, salf_release_t *rel, size_t out)
+{
+   size_t i;
+   size_t released = 0;
+
+   for (i = 0; i < h->cnt; i++) {
+      released += salf_release_push(rel, out, h->rec[i].data, h->rec[i].size) == 0;
+   }
+   h->cnt = 0;
+   h->seen = 0;
+   return released;
+}
+
+int salf_release_push(salf_release_t *rel, size_t out, const void *data, uint16_t size)
+{
+   // records start 8B aligned, array fields inside them still may not be (see probas_at())
+   size_t need = rel->arena_used + ((size + 7) & ~(size_t)7);
+
+   if (need > rel->arena_size) {
+      size_t arena_size = rel->arena_size ? 2 * rel->arena_size : SALF_BATCH_ARENA_MIN;
+      char *arena;
+      while (arena_size < need) {
+         arena_size *= 2;
+      }
+      arena = realloc(rel->arena, arena_size);
+      if (arena == NULL) {
+         return 1;
+      }
+      rel->arena = arena;
+      rel->arena_size = arena_size;
+   }
+   if (rel->cnt == rel->cap) {
+      size_t cap = rel->cap ? 2 * rel->cap : 256;
+      size_t *off = realloc(rel->off, cap * sizeof(*off));
+      uint16_t *sz, *o;
+      if (off == NULL) {
+         return 1;
+      }
+      rel->off = off;
+      sz = realloc(rel->size, cap * sizeof(*sz));
+      if (sz == NULL) {
+         return 1;
+      }
+      rel->size = sz;
+      o = realloc(rel->out, cap * sizeof(*o));
+      if (o == NULL) {
+         return 1;
+      }
+      rel->out = o;
+      rel->cap = cap;
+   }
+   memcpy(rel->arena + rel->arena_used, data, size);
+   rel->off[rel->cnt] = rel->arena_used;
+   rel->size[rel->cnt] = size;
+   rel->out[rel->cnt] = (uint16_t)out;
+   rel->cnt++;
+   rel->arena_used = need;
+   return 0;
+}
+
+void salf_release_free(salf_release_t *rel)
+{
+   free(rel->arena);
+   free(rel->off);
+   free(rel->size);
+   free(rel->out);
+   memset(rel, 0, sizeof(*rel));
+}
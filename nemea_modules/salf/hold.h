@@ -0,0 +1,166 @@
+/*!
+ * \file hold.h
+ * \brief Records held by windowed strategies
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _HOLD_H_
+#define _HOLD_H_
+
+#include <stdint.h>
+#include "salf.h"
+
+/*
+ * Windowed strategies decide on groups of records instead of single records.
+ * Records of the open window which are candidates for selection are copied
+ * into slots of salf_hold_t, at most cap of them, so memory is bounded by
+ * cap records whatever the window size. When the window closes, the held
+ * records are copied into salf_release_t of the current batch and sent with
+ * it, so they never outlive the batch in which they are released.
+ */
+
+/*!
+ * \brief Record copy held in slot.
+ */
+typedef struct salf_hold_rec_s {
+   char *data; /*< Copy of record. */
+   uint16_t size; /*< Size of record. */
+   size_t alloc; /*< Allocated size of data. */
+   double key; /*< Key of record (certainty for top-k). */
+} salf_hold_rec_t;
+
+/*!
+ * \brief Records held in open window.
+ */
+typedef struct salf_hold_s {
+   salf_hold_rec_t *rec; /*< Slots. */
+   size_t cnt; /*< Number of used slots. */
+   size_t cap; /*< Number of slots. */
+   uint64_t seen; /*< Number of records offered in open window, 0 if window is not open. */
+   uint64_t ts; /*< Time of the first record of window in ns. */
+} salf_hold_t;
+
+/*!
+ * \brief Resize slots, held records beyond cap are dropped.
+ * \param[in,out] h Held records.
+ * \param[in] cap Number of slots.
+ * \return 0 on success, 1 on allocation failure (slots are kept).
+ */
+int salf_hold_reserve(salf_hold_t *h, size_t cap);
+
+/*!
+ * \brief Free slots.
+ * \param[in,out] h Held records.
+ */
+void salf_hold_free(salf_hold_t *h);
+
+/*!
+ * \brief Copy record into slot.
+ * \param[in,out] r Slot.
+ * \param[in] data Record.
+ * \param[in] size Size of record.
+ * \param[in] key Key of record.
+ * \return 0 on success, 1 on allocation failure (slot is unchanged).
+ */
+int salf_hold_copy(salf_hold_rec_t *r, const void *data, uint16_t size, double key);
+
+/*!
+ * \brief Offer record to bounded heap of cap records with the lowest keys.
+ * The slot with the highest key is the root, record with lower key replaces it.
+ * \param[in,out] h Held records.
+ * \param[in] data Record.
+ * \param[in] size Size of record.
+ * \param[in] key Key of record.
+ */
+void salf_hold_heap_offer(salf_hold_t *h, const void *data, uint16_t size, double key);
+
+/*!
+ * \brief Drop records with the highest keys from heap until at most cnt are left.
+ * \param[in,out] h Held records.
+ * \param[in] cnt Number of records to keep.
+ */
+void salf_hold_heap_trim(salf_hold_t *h, size_t cnt);
+
+/*!
+ * \brief Release held records to output interface and close window.
+ * \param[in,out] h Held records, empty afterwards.
+ * \param[in,out] rel Records released with batch.
+ * \param[in] out Output interface.
+ * \return Number of released records.
+ */
+size_t salf_hold_release(salf_hold_t *h, salf_release_t *rel, size_t out);
+
+/*!
+ * \brief Append copy of record to released records.
+ * \param[in,out] rel Released records.
+ * \param[in] out Output interface.
+ * \param[in] data Record.
+ * \param[in] size Size of record.
+ * \return 0 on success, 1 on allocation failure.
+ */
+int salf_release_push(salf_release_t *rel, size_t out, const void *data, uint16_t size);
+
+/*!
+ * \brief Get released record.
+ * \param[in] rel Released records.
+ * \param[in] i Index of record.
+ * \return Pointer to record.
+ */
+static inline const void *salf_release_rec(const salf_release_t *rel, size_t i)
+{
+   return rel->arena + rel->off[i];
+}
+
+/*!
+ * \brief Remove all released records, memory is kept.
+ * \param[in,out] rel Released records.
+ */
+static inline void salf_release_clear(salf_release_t *rel)
+{
+   rel->cnt = 0;
+   rel->arena_used = 0;
+}
+
+/*!
+ * \brief Free memory of released records.
+ * \param[in,out] rel Released records.
+ */
+void salf_release_free(salf_release_t *rel);
+
+#endif /* _HOLD_H_ */
@@ -0,0 +1,240 @@
+/*!
+ * \file hosts.h
+ * \brief Space-Saving counters of labels per source host
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _HOSTS_H_
+#define _HOSTS_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "salf.h"
+
+/*
+ * Space-Saving keeps SALF_HOSTS_MAX counters of labels per host (64-bit
+ * hash of SRC_IP). A label of an unmonitored host takes over the counter
+ * with the minimum count and continues from it, so every host with more
+ * than labels / SALF_HOSTS_MAX labels is monitored and its count is never
+ * underestimated. Counters form a min-heap by count and are found through
+ * an open addressing table of twice the size, so a lookup is O(1) and an
+ * update O(log SALF_HOSTS_MAX), memory is fixed whatever the number of hosts.
+ */
+
+#define SALF_HOSTS_TABLE (2 * SALF_HOSTS_MAX) /*< Number of slots of lookup table (power of 2). */
+#define SALF_HOSTS_EMPTY (-1) /*< Empty slot of lookup table. */
+
+/*!
+ * \brief Counter of host.
+ */
+typedef struct salf_host_s {
+   uint64_t key; /*< Hash of host address. */
+   uint32_t count; /*< Number of labels (upper bound). */
+   uint32_t error; /*< Max overestimation of count. */
+   int16_t slot; /*< Slot of lookup table pointing to counter. */
+} salf_host_t;
+
+/*!
+ * \brief Space-Saving counters.
+ */
+typedef struct salf_hosts_s {
+   salf_host_t heap[SALF_HOSTS_MAX]; /*< Counters, min-heap by count. */
+   int16_t table[SALF_HOSTS_TABLE]; /*< Positions of counters in heap by key, linear probing. */
+   uint32_t cnt; /*< Number of used counters. */
+   uint32_t labels; /*< Number of labels counted. */
+} salf_hosts_t;
+
+/*!
+ * \brief Remove all counters.
+ * \param[out] hs Counters.
+ */
+static inline void salf_hosts_init(salf_hosts_t *hs)
+{
+   memset(hs->table, 0xff, sizeof(hs->table));
+   hs->cnt = 0;
+   hs->labels = 0;
+}
+
+/*!
+ * \brief Home slot of key in lookup table.
+ * \param[in] key Hash of host.
+ * \return Slot.
+ */
+static inline size_t salf_hosts_home(uint64_t key)
+{
+   return (size_t)(key >> 32) & (SALF_HOSTS_TABLE - 1);
+}
+
+/*!
+ * \brief Find slot of key in lookup table.
+ * \param[in] hs Counters.
+ * \param[in] key Hash of host.
+ * \return Slot of key or empty slot where key belongs.
+ */
+static inline size_t salf_hosts_find(const salf_hosts_t *hs, uint64_t key)
+{
+   size_t i = salf_hosts_home(key);
+
+   while (hs->table[i] != SALF_HOSTS_EMPTY && hs->heap[hs->table[i]].key != key) {
+      i = (i + 1) & (SALF_HOSTS_TABLE - 1);
+   }
+   return i;
+}
+
+/*!
+ * \brief Number of labels of host.
+ * \param[in] hs Counters.
+ * \param[in] key Hash of host.
+ * \return Count of monitored host (upper bound), 0 for unmonitored host.
+ */
+static inline uint32_t salf_hosts_get(const salf_hosts_t *hs, uint64_t key)
+{
+   int16_t pos = hs->table[salf_hosts_find(hs, key)];
+
+   return pos == SALF_HOSTS_EMPTY ? 0 : hs->heap[pos].count;
+}
+
+/*!
+ * \brief Remove key from lookup table (backward shift deletion).
+ * \param[in,out] hs Counters.
+ * \param[in] i Slot of key.
+ */
+static inline void salf_hosts_unlink(salf_hosts_t *hs, size_t i)
+{
+   size_t j = i;
+
+   for (;;) {
+      size_t home;
+      j = (j + 1) & (SALF_HOSTS_TABLE - 1);
+      if (hs->table[j] == SALF_HOSTS_EMPTY) {
+         break;
+      }
+      home = salf_hosts_home(hs->heap[hs->table[j]].key);
+      // move entry j to i unless its home lies cyclically in (i, j]
+      if (((j - home) & (SALF_HOSTS_TABLE - 1)) >= ((j - i) & (SALF_HOSTS_TABLE - 1))) {
+         hs->table[i] = hs->table[j];
+         hs->heap[hs->table[i]].slot = (int16_t)i;
+         i = j;
+      }
+   }
+   hs->table[i] = SALF_HOSTS_EMPTY;
+}
+
+/*!
+ * \brief Place counter at heap position and update lookup table.
+ * \param[in,out] hs Counters.
+ * \param[in] pos Position in heap.
+ * \param[in] h Counter.
+ */
+static inline void salf_hosts_place(salf_hosts_t *hs, size_t pos, const salf_host_t *h)
+{
+   hs->heap[pos] = *h;
+   hs->table[h->slot] = (int16_t)pos;
+}
+
+/*!
+ * \brief Move counter at position down to restore heap order.
+ * \param[in,out] hs Counters.
+ * \param[in] pos Position in heap.
+ */
+static inline void salf_hosts_sift_down(salf_hosts_t *hs, size_t pos)
+{
+   salf_host_t h = hs->heap[pos];
+
+   for (;;) {
+      size_t c = 2 * pos + 1;
+      if (c >= hs->cnt) {
+         break;
+      }
+      if (c + 1 < hs->cnt && hs->heap[c + 1].count < hs->heap[c].count) {
+         c++;
+      }
+      if (hs->heap[c].count >= h.count) {
+         break;
+      }
+      salf_hosts_place(hs, pos, &hs->heap[c]);
+      pos = c;
+   }
+   salf_hosts_place(hs, pos, &h);
+}
+
+/*!
+ * \brief Count label of host.
+ * \param[in,out] hs Counters.
+ * \param[in] key Hash of host.
+ */
+static inline void salf_hosts_add(salf_hosts_t *hs, uint64_t key)
+{
+   size_t i = salf_hosts_find(hs, key);
+   salf_host_t h;
+
+   hs->labels++;
+   if (hs->table[i] != SALF_HOSTS_EMPTY) {
+      size_t pos = (size_t)hs->table[i];
+      hs->heap[pos].count++;
+      salf_hosts_sift_down(hs, pos);
+      return;
+   }
+   if (hs->cnt < SALF_HOSTS_MAX) {
+      // new counters have the minimal count 1, they go to the end and up to the root level of ones
+      size_t pos = hs->cnt++;
+      h.key = key;
+      h.count = 1;
+      h.error = 0;
+      h.slot = (int16_t)i;
+      while (pos > 0 && hs->heap[(pos - 1) / 2].count > h.count) {
+         salf_hosts_place(hs, pos, &hs->heap[(pos - 1) / 2]);
+         pos = (pos - 1) / 2;
+      }
+      salf_hosts_place(hs, pos, &h);
+      return;
+   }
+   // take over counter with the minimal count
+   salf_hosts_unlink(hs, (size_t)hs->heap[0].slot);
+   i = salf_hosts_find(hs, key);
+   h = hs->heap[0];
+   h.key = key;
+   h.error = h.count;
+   h.count++;
+   h.slot = (int16_t)i;
+   salf_hosts_place(hs, 0, &h);
+   salf_hosts_sift_down(hs, 0);
+}
+
+#endif /* _HOSTS_H_ */
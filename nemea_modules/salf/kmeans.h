@@ -0,0 +1,235 @@
+/*!
+ * \file kmeans.h
+ * \brief Online k-means clusters of feature vectors with label counts
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _KMEANS_H_
+#define _KMEANS_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "salf.h"
+#include "fvec.h"
+#include "scaler.h"
+
+/*
+ * After SALF_CLUSTER_WARMUP flows, which only train standardization,
+ * standardized feature vectors are clustered by online (sequential
+ * mini-batch) k-means: a vector moves its nearest centroid by 1 / count of
+ * the centroid, count is capped at SALF_CLUSTER_COUNT_MAX so centroids keep
+ * following the traffic. Centroids are seeded by the leader rule, a vector
+ * farther than one standard deviation from all centroids starts a new one
+ * until there are k of them. Centroids are stored by features, padded to
+ * FVEC_LANES with infinite coordinates, so distances to all of them are one
+ * call of the fvec_dist2() kernel.
+ *
+ * Every cluster counts flows and labels (halved every SALF_CLUSTER_HORIZON
+ * flows) and the mean distance of its flows (radius). Diversity weight of
+ * a flow is 1 / (1 + labels / mean labels of clusters) of its cluster, i.e.
+ * 1 for clusters without labels and 1/2 for clusters with the mean number,
+ * so labels spread over the clusters instead of following their sizes. It is
+ * scaled by 2 * d / (d + radius) for flows at distance d closer to the
+ * centroid than the radius, which are the most redundant.
+ */
+
+/*!
+ * \brief Online k-means clusters.
+ */
+typedef struct salf_kmeans_s {
+   float *c; /*< Centroids by features, SALF_FEATURES_MAX rows of SALF_CLUSTERS_MAX, NULL until first use. */
+   float radius[SALF_CLUSTERS_MAX]; /*< Mean distance of flows to centroid. */
+   float flows[SALF_CLUSTERS_MAX]; /*< Number of flows of cluster (halved every horizon). */
+   float labels[SALF_CLUSTERS_MAX]; /*< Number of labeled flows of cluster (halved every horizon). */
+   float labeled; /*< Number of labeled flows of all clusters (halved every horizon). */
+   uint32_t count[SALF_CLUSTERS_MAX]; /*< Number of updates of centroid, capped. */
+   uint32_t k; /*< Number of seeded centroids. */
+   uint32_t total; /*< Number of flows since last halving. */
+   salf_scaler_t scaler; /*< Standardization of features. */
+} salf_kmeans_t;
+
+/*!
+ * \brief Allocate centroids.
+ * \param[in,out] km Clusters.
+ * \return 0 on success, 1 on allocation failure.
+ */
+static inline int salf_kmeans_alloc(salf_kmeans_t *km)
+{
+   size_t i;
+
+   km->c = malloc(SALF_FEATURES_MAX * SALF_CLUSTERS_MAX * sizeof(*km->c));
+   if (km->c == NULL) {
+      return 1;
+   }
+   for (i = 0; i < SALF_FEATURES_MAX * SALF_CLUSTERS_MAX; i++) {
+      km->c[i] = HUGE_VALF;
+   }
+   memset(km->radius, 0, sizeof(km->radius));
+   memset(km->flows, 0, sizeof(km->flows));
+   memset(km->labels, 0, sizeof(km->labels));
+   memset(km->count, 0, sizeof(km->count));
+   km->labeled = 0;
+   km->k = 0;
+   km->total = 0;
+   salf_scaler_init(&km->scaler);
+   return 0;
+}
+
+/*!
+ * \brief Free centroids.
+ * \param[in,out] km Clusters.
+ */
+static inline void salf_kmeans_free(salf_kmeans_t *km)
+{
+   free(km->c);
+   km->c = NULL;
+}
+
+/*!
+ * \brief Number of centroid slots passed to distance kernel.
+ * \param[in] k Number of centroids.
+ * \return k rounded up to FVEC_LANES.
+ */
+static inline size_t salf_kmeans_lanes(size_t k)
+{
+   return (k + FVEC_LANES - 1) / FVEC_LANES * FVEC_LANES;
+}
+
+/*!
+ * \brief Assign feature vector to cluster and update clusters.
+ * \param[in,out] km Clusters.
+ * \param[in] x Feature vector.
+ * \param[in] cnt Number of features.
+ * \param[in] kmax Max number of centroids (at most SALF_CLUSTERS_MAX).
+ * \param[out] d Distance of x to centroid of its cluster (before update).
+ * \return Cluster of x, SALF_CLUSTERS_MAX during warm-up.
+ */
+static inline size_t salf_kmeans_assign(salf_kmeans_t *km, const float *x, size_t cnt, size_t kmax, float *d)
+{
+   float z[SALF_FEATURES_MAX];
+   float dist[SALF_CLUSTERS_MAX];
+   size_t m = salf_kmeans_lanes(km->k);
+   size_t j = 0;
+   size_t f, i;
+   float eta;
+
+   if (kmax > SALF_CLUSTERS_MAX) {
+      kmax = SALF_CLUSTERS_MAX;
+   }
+   salf_scaler_apply(&km->scaler, x, z, cnt);
+   *d = HUGE_VALF;
+   if (km->scaler.n <= SALF_CLUSTER_WARMUP) {
+      return SALF_CLUSTERS_MAX;
+   }
+   if (km->k > 0) {
+      fvec_dist2(km->c, SALF_CLUSTERS_MAX, m, z, cnt, dist);
+      for (i = 1; i < m; i++) {
+         if (dist[i] < dist[j]) {
+            j = i;
+         }
+      }
+      *d = sqrtf(dist[j]);
+   }
+   if (km->k < kmax && !(*d <= 1.0f)) {
+      // leader seeding, the vector becomes a new centroid
+      j = km->k++;
+      for (f = 0; f < cnt; f++) {
+         km->c[f * SALF_CLUSTERS_MAX + j] = z[f];
+      }
+      km->count[j] = 1;
+      *d = 0;
+   } else {
+      if (km->count[j] < SALF_CLUSTER_COUNT_MAX) {
+         km->count[j]++;
+      }
+      eta = 1.0f / (float)km->count[j];
+      for (f = 0; f < cnt; f++) {
+         float *c = &km->c[f * SALF_CLUSTERS_MAX + j];
+         *c += eta * (z[f] - *c);
+      }
+      km->radius[j] += eta * (*d - km->radius[j]);
+   }
+   km->flows[j] += 1;
+   if (++km->total >= SALF_CLUSTER_HORIZON) {
+      for (i = 0; i < km->k; i++) {
+         km->flows[i] *= 0.5f;
+         km->labels[i] *= 0.5f;
+      }
+      km->labeled *= 0.5f;
+      km->total = 0;
+   }
+   return j;
+}
+
+/*!
+ * \brief Diversity weight of flow.
+ * \param[in] km Clusters.
+ * \param[in] j Cluster of flow, SALF_CLUSTERS_MAX if none.
+ * \param[in] d Distance of flow to centroid.
+ * \return Weight in [0,1], 1 for flows of clusters without labels.
+ */
+static inline double salf_kmeans_diversity(const salf_kmeans_t *km, size_t j, float d)
+{
+   double r;
+   double near;
+
+   if (j >= SALF_CLUSTERS_MAX) {
+      return 1.0;
+   }
+   r = km->labeled > 0 ? km->labels[j] * km->k / km->labeled : 0;
+   near = d < km->radius[j] ? 2.0 * d / (d + km->radius[j]) : 1.0;
+   return near / (1.0 + r);
+}
+
+/*!
+ * \brief Count label of flow of cluster.
+ * \param[in,out] km Clusters.
+ * \param[in] j Cluster of flow, SALF_CLUSTERS_MAX if none.
+ */
+static inline void salf_kmeans_label(salf_kmeans_t *km, size_t j)
+{
+   if (j < SALF_CLUSTERS_MAX) {
+      km->labels[j] += 1;
+      km->labeled += 1;
+   }
+}
+
+#endif /* _KMEANS_H_ */
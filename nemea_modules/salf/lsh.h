@@ -0,0 +1,205 @@
+/*!
+ * \file lsh.h
+ * \brief SimHash bucket table of labeled feature vectors
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _LSH_H_
+#define _LSH_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "salf.h"
+#include "rng.h"
+#include "fvec.h"
+#include "scaler.h"
+
+/*
+ * Feature vectors are standardized (scaler.h) and projected on 64 random hyperplanes (SimHash), vectors at a
+ * small angle agree in most bits. The signature is split into bands, every
+ * band of a labeled flow is stored in a direct mapped slot of the bucket
+ * table together with time of the label. A flow is a near-duplicate if any
+ * of its bands is found with age below TTL: more bands of fewer bits match
+ * more distant vectors. Colliding bands overwrite each other, which only
+ * loses suppressions, and expired slots need no sweeping. Hyperplanes are
+ * generated from a fixed seed, so all instances agree on signatures.
+ */
+
+#define SALF_LSH_BANDS_MAX 8 /*< Max number of bands of signature. */
+#define SALF_LSH_SEED 0x6c736873696d68ULL /*< Seed of hyperplanes. */
+
+/*!
+ * \brief Slot of bucket table.
+ */
+typedef struct salf_lsh_slot_s {
+   uint32_t tag; /*< Hash of band (odd), 0 if empty. */
+   uint32_t ms; /*< Time of label in ms (wraps). */
+} salf_lsh_slot_t;
+
+/*!
+ * \brief Bucket table and signature state.
+ */
+typedef struct salf_lsh_s {
+   salf_lsh_slot_t *slot; /*< Bucket table of SALF_LSH_SLOTS slots, NULL until first use. */
+   float *planes; /*< Normals of hyperplanes, SALF_FEATURES_MAX rows of FVEC_SIMHASH_BITS. */
+   salf_scaler_t scaler; /*< Standardization of features. */
+} salf_lsh_t;
+
+/*!
+ * \brief Allocate empty table and generate hyperplanes.
+ * \param[in,out] lsh Table.
+ * \return 0 on success, 1 on allocation failure.
+ */
+static inline int salf_lsh_alloc(salf_lsh_t *lsh)
+{
+   rng_t rng;
+   size_t i;
+
+   lsh->slot = calloc(SALF_LSH_SLOTS, sizeof(*lsh->slot));
+   lsh->planes = malloc(SALF_FEATURES_MAX * FVEC_SIMHASH_BITS * sizeof(*lsh->planes));
+   if (lsh->slot == NULL || lsh->planes == NULL) {
+      free(lsh->slot);
+      free(lsh->planes);
+      lsh->slot = NULL;
+      lsh->planes = NULL;
+      return 1;
+   }
+   rng_seed(&rng, SALF_LSH_SEED, 0);
+   for (i = 0; i < SALF_FEATURES_MAX * FVEC_SIMHASH_BITS; i++) {
+      lsh->planes[i] = (float)rng_normal(&rng, 0, 1);
+   }
+   salf_scaler_init(&lsh->scaler);
+   return 0;
+}
+
+/*!
+ * \brief Free table.
+ * \param[in,out] lsh Table.
+ */
+static inline void salf_lsh_free(salf_lsh_t *lsh)
+{
+   free(lsh->slot);
+   free(lsh->planes);
+   lsh->slot = NULL;
+   lsh->planes = NULL;
+}
+
+/*!
+ * \brief Standardize feature vector and compute its signature.
+ * Signatures are valid once the scaler is warm (salf_scaler_warm()), earlier
+ * ones only train the standardization and are neither looked up nor added.
+ * \param[in,out] lsh Table, statistics of scaler are updated by x.
+ * \param[in] x Feature vector.
+ * \param[in] cnt Number of features.
+ * \return SimHash signature.
+ */
+static inline uint64_t salf_lsh_signature(salf_lsh_t *lsh, const float *x, size_t cnt)
+{
+   float z[SALF_FEATURES_MAX];
+
+   salf_scaler_apply(&lsh->scaler, x, z, cnt);
+   return fvec_simhash(lsh->planes, z, cnt);
+}
+
+/*!
+ * \brief Slot of band of signature.
+ * \param[in] sig Signature.
+ * \param[in] band Band.
+ * \param[in] bands Number of bands (1, 2, 4 or 8).
+ * \param[out] tag Tag of band.
+ * \return Index of slot, every band has its own part of table.
+ */
+static inline size_t salf_lsh_index(uint64_t sig, unsigned int band, unsigned int bands, uint32_t *tag)
+{
+   unsigned int bits = FVEC_SIMHASH_BITS / bands;
+   uint64_t h = bits == 64 ? sig : (sig >> (band * bits)) & ((1ULL << bits) - 1);
+   size_t part = SALF_LSH_SLOTS / bands;
+
+   // splitmix64 finalizer
+   h = (h + band) * 0x9e3779b97f4a7c15ULL;
+   h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+   h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+   h ^= h >> 31;
+   *tag = (uint32_t)(h >> 32) | 1;
+   return band * part + (size_t)(h & (part - 1));
+}
+
+/*!
+ * \brief Test whether any band of signature was labeled recently.
+ * \param[in] lsh Table.
+ * \param[in] sig Signature.
+ * \param[in] bands Number of bands.
+ * \param[in] ms Current time in ms.
+ * \param[in] ttl TTL in ms.
+ * \return Nonzero if signature is a near-duplicate of a labeled flow.
+ */
+static inline int salf_lsh_recent(const salf_lsh_t *lsh, uint64_t sig, unsigned int bands, uint32_t ms, uint32_t ttl)
+{
+   unsigned int b;
+   uint32_t tag;
+
+   for (b = 0; b < bands; b++) {
+      const salf_lsh_slot_t *sl = &lsh->slot[salf_lsh_index(sig, b, bands, &tag)];
+      if (sl->tag == tag && ms - sl->ms < ttl) {
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/*!
+ * \brief Store bands of labeled signature.
+ * \param[in,out] lsh Table.
+ * \param[in] sig Signature.
+ * \param[in] bands Number of bands.
+ * \param[in] ms Current time in ms.
+ */
+static inline void salf_lsh_add(salf_lsh_t *lsh, uint64_t sig, unsigned int bands, uint32_t ms)
+{
+   unsigned int b;
+   uint32_t tag;
+
+   for (b = 0; b < bands; b++) {
+      salf_lsh_slot_t *sl = &lsh->slot[salf_lsh_index(sig, b, bands, &tag)];
+      sl->tag = tag;
+      sl->ms = ms;
+   }
+}
+
+#endif /* _LSH_H_ */
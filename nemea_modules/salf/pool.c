@@ -0,0 +1,241 @@
+/*!
+ * \file pool.c
+ * \brief Pool of worker threads running SALF strategy
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "pool.h"
+#include <sched.h>
+
+#define POOL_SPIN 256 /*< Number of empty polls before the thread yields. */
+#define POOL_SLEEP_NS 50000 /*< Sleep of idle thread after POOL_SPIN polls. */
+
+/*!
+ * \brief Back off after unsuccessful poll.
+ * \param[in,out] idle Number of unsuccessful polls in a row.
+ */
+static void salf_pool_backoff(unsigned int *idle)
+{
+   struct timespec ts = {0, POOL_SLEEP_NS};
+
+   if (++(*idle) < POOL_SPIN) {
+      sched_yield();
+   } else {
+      nanosleep(&ts, NULL);
+   }
+}
+
+static void *salf_worker_run(void *arg)
+{
+   salf_worker_t *w = arg;
+   salf_batch_t *batch;
+   unsigned int idle = 0;
+
+   for (;;) {
+      batch = spsc_pop(&w->in);
+      if (batch == NULL) {
+         if (atomic_load_explicit(&w->stop, memory_order_acquire)) {
+            // stop is set after the last submit, check the ring once more
+            batch = spsc_pop(&w->in);
+            if (batch == NULL) {
+               break;
+            }
+         } else {
+            salf_pool_backoff(&idle);
+            continue;
+         }
+      }
+      idle = 0;
+      w->seen += batch->cnt;
+      w->selected += salf_strategy_set_batch(&w->set, batch);
+      spsc_push(&w->out, batch);
+   }
+   return NULL;
+}
+
+int salf_pool_init(salf_pool_t *pool, size_t cnt, size_t batch_size, const salf_params_t *params, size_t nout, uint64_t seed, salf_ckpt_t *ckpt)
+{
+   size_t i, j;
+
+   memset(pool, 0, sizeof(*pool));
+   pool->worker = calloc(cnt, sizeof(*pool->worker));
+   if (pool->worker == NULL) {
+      return 1;
+   }
+   pool->cnt = cnt;
+
+   for (i = 0; i < cnt; i++) {
+      salf_worker_t *w = &pool->worker[i];
+      w->id = i;
+      // streams 0 .. nout - 1 are used by the receiving thread
+      if (salf_strategy_set_init(&w->set, params, nout, seed, (i + 1) * nout)) {
+         salf_pool_free(pool);
+         return 1;
+      }
+      // every worker decides 1/cnt of the stream
+      salf_strategy_set_share(&w->set, 1.0 / (double)cnt);
+      if (ckpt != NULL) {
+         salf_ckpt_attach(ckpt, &w->set, i);
+      }
+      atomic_init(&w->stop, 0);
+      spsc_init(&w->in, w->in_slot, SALF_WORKER_BATCHES);
+      spsc_init(&w->out, w->out_slot, SALF_WORKER_BATCHES);
+      for (j = 0; j < SALF_WORKER_BATCHES; j++) {
+         if (salf_batch_init(&w->batch[j], batch_size, nout)) {
+            salf_pool_free(pool);
+            return 1;
+         }
+         w->free[w->free_cnt++] = &w->batch[j];
+      }
+   }
+   for (i = 0; i < cnt; i++) {
+      salf_worker_t *w = &pool->worker[i];
+      if (pthread_create(&w->thread, NULL, salf_worker_run, w) != 0) {
+         salf_pool_stop(pool);
+         salf_pool_free(pool);
+         return 1;
+      }
+      w->running = 1;
+   }
+   return 0;
+}
+
+salf_batch_t *salf_pool_get(salf_pool_t *pool)
+{
+   salf_worker_t *w = &pool->worker[pool->next_submit];
+
+   if (w->free_cnt == 0) {
+      return NULL;
+   }
+   return w->free[--w->free_cnt];
+}
+
+void salf_pool_submit(salf_pool_t *pool, salf_batch_t *batch)
+{
+   // ring has room for all batches of worker, push cannot fail
+   spsc_push(&pool->worker[pool->next_submit].in, batch);
+   pool->next_submit = (pool->next_submit + 1) % pool->cnt;
+   pool->in_flight++;
+}
+
+salf_batch_t *salf_pool_collect(salf_pool_t *pool, int wait)
+{
+   salf_worker_t *w;
+   salf_batch_t *batch;
+   unsigned int idle = 0;
+
+   if (pool->in_flight == 0) {
+      return NULL;
+   }
+   w = &pool->worker[pool->next_collect];
+   while ((batch = spsc_pop(&w->out)) == NULL) {
+      if (!wait) {
+         return NULL;
+      }
+      salf_pool_backoff(&idle);
+   }
+   pool->next_collect = (pool->next_collect + 1) % pool->cnt;
+   pool->in_flight--;
+   return batch;
+}
+
+void salf_pool_release(salf_pool_t *pool, salf_batch_t *batch)
+{
+   size_t i;
+
+   for (i = 0; i < pool->cnt; i++) {
+      salf_worker_t *w = &pool->worker[i];
+      if (batch >= w->batch && batch < w->batch + SALF_WORKER_BATCHES) {
+         batch->cnt = 0;
+         batch->arena_used = 0;
+         w->free[w->free_cnt++] = batch;
+         return;
+      }
+   }
+}
+
+void salf_pool_stop(salf_pool_t *pool)
+{
+   size_t i;
+
+   for (i = 0; i < pool->cnt; i++) {
+      atomic_store_explicit(&pool->worker[i].stop, 1, memory_order_release);
+   }
+   for (i = 0; i < pool->cnt; i++) {
+      if (pool->worker[i].running) {
+         pthread_join(pool->worker[i].thread, NULL);
+         pool->worker[i].running = 0;
+      }
+   }
+}
+
+void salf_pool_print_stats(const salf_pool_t *pool)
+{
+   uint64_t seen = 0;
+   uint64_t selected = 0;
+   size_t i;
+
+   for (i = 0; i < pool->cnt; i++) {
+      const salf_worker_t *w = &pool->worker[i];
+      fprintf(stderr, "Info: Worker %zu: decided %" PRIu64 ", selected %" PRIu64 " (%.2f%%)\n",
+              i, w->seen, w->selected, w->seen > 0 ? (double)w->selected / w->seen * 100 : 0);
+      seen += w->seen;
+      selected += w->selected;
+   }
+   fprintf(stderr, "Info: Workers total: decided %" PRIu64 ", selected %" PRIu64 " (%.2f%%)\n",
+           seen, selected, seen > 0 ? (double)selected / seen * 100 : 0);
+}
+
+void salf_pool_free(salf_pool_t *pool)
+{
+   size_t i, j;
+
+   if (pool->worker == NULL) {
+      return;
+   }
+   for (i = 0; i < pool->cnt; i++) {
+      for (j = 0; j < SALF_WORKER_BATCHES; j++) {
+         salf_batch_free(&pool->worker[i].batch[j]);
+      }
+      salf_strategy_set_free(&pool->worker[i].set);
+   }
+   free(pool->worker);
+   pool->worker = NULL;
+   pool->cnt = 0;
+}
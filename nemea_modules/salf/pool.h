@@ -0,0 +1,158 @@
+/*!
+ * \file pool.h
+ * \brief Pool of worker threads running SALF strategy
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include <pthread.h>
+#include "salf.h"
+#include "strategy.h"
+#include "spsc.h"
+#include "checkpoint.h"
+
+/*
+ * The receiving thread fills batches and hands them over to workers in
+ * round-robin order. Every worker decides its batches with its own strategy
+ * state and returns them back; the receiving thread collects and sends them
+ * in the original order.
+ *
+ * Budget accounting: every worker runs the budget check of the strategy
+ * (labeled fraction of its window < budget) over its own shard of the stream. If every shard satisfies
+ * u_i <= budget * t_i, the whole stream satisfies sum(u_i) <= budget * sum(t_i),
+ * so the global label fraction respects the budget without any shared state
+ * in the per-record path. Counters of workers are merged when statistics
+ * are printed.
+ */
+
+/*!
+ * \brief Worker thread.
+ */
+typedef struct salf_worker_s {
+   spsc_t in; /*< Batches to decide (receiving thread -> worker). */
+   spsc_t out; /*< Decided batches (worker -> receiving thread). */
+   void *in_slot[SALF_WORKER_BATCHES]; /*< Storage of in ring. */
+   void *out_slot[SALF_WORKER_BATCHES]; /*< Storage of out ring. */
+   salf_batch_t batch[SALF_WORKER_BATCHES]; /*< Batches owned by worker. */
+   salf_batch_t *free[SALF_WORKER_BATCHES]; /*< Empty batches, used by receiving thread only. */
+   size_t free_cnt; /*< Number of empty batches. */
+   salf_strategy_set_t set; /*< Strategy instances, owned by worker thread. */
+   uint64_t seen; /*< Records decided by worker. */
+   uint64_t selected; /*< Records selected by worker. */
+   size_t id; /*< Number of worker. */
+   atomic_int stop; /*< Set by receiving thread to terminate worker. */
+   pthread_t thread; /*< Thread. */
+   int running; /*< Thread was started. */
+} salf_worker_t;
+
+/*!
+ * \brief Pool of workers.
+ */
+typedef struct salf_pool_s {
+   salf_worker_t *worker; /*< Workers. */
+   size_t cnt; /*< Number of workers. */
+   size_t next_submit; /*< Worker receiving the next batch. */
+   size_t next_collect; /*< Worker returning the oldest batch in flight. */
+   size_t in_flight; /*< Number of submitted and not collected batches. */
+} salf_pool_t;
+
+/*!
+ * \brief Allocate batches and start workers.
+ * \param[out] pool Pool.
+ * \param[in] cnt Number of workers.
+ * \param[in] batch_size Number of records in batch.
+ * \param[in] params Parameters of strategies run by workers, one per output interface.
+ * \param[in] nout Number of output interfaces.
+ * \param[in] seed Seed of random number generators.
+ * \param[in] ckpt State file with cnt shards, worker i restores and saves shard i; NULL if not used.
+ * \return 0 on success, 1 on error.
+ */
+int salf_pool_init(salf_pool_t *pool, size_t cnt, size_t batch_size, const salf_params_t *params, size_t nout, uint64_t seed, salf_ckpt_t *ckpt);
+
+/*!
+ * \brief Get empty batch for the next worker.
+ * \param[in] pool Pool.
+ * \return Batch or NULL if all batches of the worker are in flight.
+ */
+salf_batch_t *salf_pool_get(salf_pool_t *pool);
+
+/*!
+ * \brief Hand batch obtained by salf_pool_get() over to the worker.
+ * \param[in] pool Pool.
+ * \param[in] batch Filled batch.
+ */
+void salf_pool_submit(salf_pool_t *pool, salf_batch_t *batch);
+
+/*!
+ * \brief Get the oldest decided batch.
+ * \param[in] pool Pool.
+ * \param[in] wait Wait until the oldest batch is decided.
+ * \return Batch or NULL if nothing is in flight (or the oldest batch is not decided yet and wait is 0).
+ */
+salf_batch_t *salf_pool_collect(salf_pool_t *pool, int wait);
+
+/*!
+ * \brief Return collected batch to its worker.
+ * \param[in] pool Pool.
+ * \param[in] batch Batch returned by salf_pool_collect().
+ */
+void salf_pool_release(salf_pool_t *pool, salf_batch_t *batch);
+
+/*!
+ * \brief Stop and join workers.
+ * Batches in flight are decided first.
+ * \param[in] pool Pool.
+ */
+void salf_pool_stop(salf_pool_t *pool);
+
+/*!
+ * \brief Print merged and per-worker counters.
+ * \param[in] pool Stopped pool.
+ */
+void salf_pool_print_stats(const salf_pool_t *pool);
+
+/*!
+ * \brief Free memory of pool.
+ * \param[in] pool Stopped pool.
+ */
+void salf_pool_free(salf_pool_t *pool);
+
+#endif /* _POOL_H_ */
@@ -0,0 +1,493 @@
+/*!
+ * \file probas.c
+ * \brief Kernels for reduction of probability arrays
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "probas.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PROBAS_X86 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Max is computed as m = (x > m) ? x : m in every kernel. This is exactly the
+ * semantics of the maxpd instruction with the accumulator as the second
+ * operand, so NaN is skipped and the result does not depend on the order of
+ * elements, i.e. all kernels return bit-identical values.
+ *
+ * Top-2 (margin) keeps the largest m1 and the second largest m2 in every
+ * lane: m2 = max(min(m1, x), m2), m1 = max(x, m1), lanes are merged at the
+ * end. NaN falls through both (min returns x, max keeps the accumulator),
+ * so margin kernels are bit-identical as well.
+ *
+ * Logarithm of entropy kernels splits x = 2^e * m with m in [sqrt(2)/2, sqrt(2))
+ * by integer operations on the exponent field, ln(m) = 2 * atanh(f) with
+ * f = (m - 1) / (m + 1) is evaluated by the series up to f^7, |f| < 0.172.
+ */
+
+#define PROBAS_SQRT2 1.41421356237309504880
+#define PROBAS_LN2 0.69314718055994530942
+#define PROBAS_MANT_MASK 0x000fffffffffffffULL /*< Mantissa bits of double. */
+#define PROBAS_ONE_BITS 0x3ff0000000000000ULL /*< Bits of 1.0. */
+#define PROBAS_2P52_BITS 0x4330000000000000ULL /*< Bits of 2^52, exponent field ORed into mantissa converts it to double. */
+#define PROBAS_2P52 4503599627370496.0
+
+probas_max_fnc_t probas_max = &probas_max_scalar;
+probas_margin_fnc_t probas_margin = &probas_margin_scalar;
+probas_entropy_fnc_t probas_entropy = &probas_entropy_scalar;
+
+double probas_max_scalar(const double *p, size_t n)
+{
+   double max = 0;
+   size_t i;
+   for (i = 0; i < n; i++) {
+      double v = probas_at(p, i);
+      if (v > max) {
+         max = v;
+      }
+   }
+   return max;
+}
+
+/*!
+ * \brief Add element to top-2.
+ */
+static inline void probas_top2_add(double *m1, double *m2, double x)
+{
+   double lo = *m1 < x ? *m1 : x;
+   *m2 = lo > *m2 ? lo : *m2;
+   *m1 = x > *m1 ? x : *m1;
+}
+
+/*!
+ * \brief Merge top-2 of lanes into m1, m2.
+ */
+static inline void probas_top2_lanes(double *m1, double *m2, const double *l1, const double *l2, size_t lanes)
+{
+   size_t i;
+   for (i = 0; i < lanes; i++) {
+      probas_top2_add(m1, m2, l1[i]);
+      probas_top2_add(m1, m2, l2[i]);
+   }
+}
+
+double probas_margin_scalar(const double *p, size_t n)
+{
+   double m1 = 0;
+   double m2 = 0;
+   size_t i;
+   for (i = 0; i < n; i++) {
+      probas_top2_add(&m1, &m2, probas_at(p, i));
+   }
+   return m1 - m2;
+}
+
+/*!
+ * \brief ln(m) for m in [sqrt(2)/2, sqrt(2)).
+ */
+static inline double probas_log_mant(double m)
+{
+   double f = (m - 1) / (m + 1);
+   double f2 = f * f;
+   return f * (2.0 + f2 * (2.0 / 3 + f2 * (2.0 / 5 + f2 * (2.0 / 7))));
+}
+
+double probas_log(double x)
+{
+   uint64_t bits;
+   double m;
+   double e;
+
+   memcpy(&bits, &x, sizeof(bits));
+   e = (double)(int)(bits >> 52) - 1023;
+   bits = (bits & PROBAS_MANT_MASK) | PROBAS_ONE_BITS;
+   memcpy(&m, &bits, sizeof(m));
+   if (m > PROBAS_SQRT2) {
+      m *= 0.5;
+      e += 1;
+   }
+   return e * PROBAS_LN2 + probas_log_mant(m);
+}
+
+double probas_entropy_scalar(const double *p, size_t n)
+{
+   double sum = 0;
+   size_t i;
+   for (i = 0; i < n; i++) {
+      double v = probas_at(p, i);
+      if (v > 0) {
+         sum -= v * probas_log(v);
+      }
+   }
+   return sum;
+}
+
+#ifdef PROBAS_X86
+
+__attribute__((target("sse2")))
+static double probas_max_sse2(const double *p, size_t n)
+{
+   __m128d m0 = _mm_setzero_pd();
+   __m128d m1 = _mm_setzero_pd();
+   double tmp[2];
+   double max;
+   size_t i = 0;
+
+   for (; i + 4 <= n; i += 4) {
+      m0 = _mm_max_pd(_mm_loadu_pd(p + i), m0);
+      m1 = _mm_max_pd(_mm_loadu_pd(p + i + 2), m1);
+   }
+   m0 = _mm_max_pd(m1, m0);
+   _mm_storeu_pd(tmp, m0);
+   max = tmp[1] > tmp[0] ? tmp[1] : tmp[0];
+   for (; i < n; i++) {
+      double v = probas_at(p, i);
+      if (v > max) {
+         max = v;
+      }
+   }
+   return max;
+}
+
+__attribute__((target("sse2")))
+static double probas_margin_sse2(const double *p, size_t n)
+{
+   __m128d a1 = _mm_setzero_pd();
+   __m128d a2 = _mm_setzero_pd();
+   __m128d b1 = _mm_setzero_pd();
+   __m128d b2 = _mm_setzero_pd();
+   double l1[4];
+   double l2[4];
+   double m1 = 0;
+   double m2 = 0;
+   size_t i = 0;
+
+   for (; i + 4 <= n; i += 4) {
+      __m128d x = _mm_loadu_pd(p + i);
+      __m128d y = _mm_loadu_pd(p + i + 2);
+      a2 = _mm_max_pd(_mm_min_pd(a1, x), a2);
+      a1 = _mm_max_pd(x, a1);
+      b2 = _mm_max_pd(_mm_min_pd(b1, y), b2);
+      b1 = _mm_max_pd(y, b1);
+   }
+   _mm_storeu_pd(l1, a1);
+   _mm_storeu_pd(l1 + 2, b1);
+   _mm_storeu_pd(l2, a2);
+   _mm_storeu_pd(l2 + 2, b2);
+   probas_top2_lanes(&m1, &m2, l1, l2, 4);
+   for (; i < n; i++) {
+      probas_top2_add(&m1, &m2, probas_at(p, i));
+   }
+   return m1 - m2;
+}
+
+/*!
+ * \brief Vector ln(x) for two positive doubles, see probas_log().
+ */
+__attribute__((target("sse2")))
+static inline __m128d probas_log_sse2(__m128d x)
+{
+   __m128i bits = _mm_castpd_si128(x);
+   __m128d m = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(PROBAS_MANT_MASK)), _mm_set1_epi64x(PROBAS_ONE_BITS)));
+   __m128d e = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(bits, 52), _mm_set1_epi64x(PROBAS_2P52_BITS))), _mm_set1_pd(PROBAS_2P52 + 1023));
+   __m128d big = _mm_cmpgt_pd(m, _mm_set1_pd(PROBAS_SQRT2));
+   __m128d one = _mm_set1_pd(1.0);
+   __m128d f, f2, r;
+
+   m = _mm_or_pd(_mm_and_pd(big, _mm_mul_pd(m, _mm_set1_pd(0.5))), _mm_andnot_pd(big, m));
+   e = _mm_add_pd(e, _mm_and_pd(big, one));
+   f = _mm_div_pd(_mm_sub_pd(m, one), _mm_add_pd(m, one));
+   f2 = _mm_mul_pd(f, f);
+   r = _mm_add_pd(_mm_set1_pd(2.0 / 5), _mm_mul_pd(f2, _mm_set1_pd(2.0 / 7)));
+   r = _mm_add_pd(_mm_set1_pd(2.0 / 3), _mm_mul_pd(f2, r));
+   r = _mm_add_pd(_mm_set1_pd(2.0), _mm_mul_pd(f2, r));
+   return _mm_add_pd(_mm_mul_pd(e, _mm_set1_pd(PROBAS_LN2)), _mm_mul_pd(f, r));
+}
+
+__attribute__((target("sse2")))
+static double probas_entropy_sse2(const double *p, size_t n)
+{
+   __m128d s0 = _mm_setzero_pd();
+   double tmp[2];
+   double sum;
+   size_t i = 0;
+
+   for (; i + 2 <= n; i += 2) {
+      __m128d x = _mm_loadu_pd(p + i);
+      __m128d pos = _mm_cmpgt_pd(x, _mm_setzero_pd());
+      s0 = _mm_add_pd(s0, _mm_and_pd(pos, _mm_mul_pd(x, probas_log_sse2(x))));
+   }
+   _mm_storeu_pd(tmp, s0);
+   sum = -(tmp[0] + tmp[1]);
+   for (; i < n; i++) {
+      double v = probas_at(p, i);
+      if (v > 0) {
+         sum -= v * probas_log(v);
+      }
+   }
+   return sum;
+}
+
+__attribute__((target("avx2")))
+static double probas_max_avx2(const double *p, size_t n)
+{
+   __m256d m0 = _mm256_setzero_pd();
+   __m256d m1 = _mm256_setzero_pd();
+   __m128d m;
+   double tmp[2];
+   double max;
+   size_t i = 0;
+
+   for (; i + 8 <= n; i += 8) {
+      m0 = _mm256_max_pd(_mm256_loadu_pd(p + i), m0);
+      m1 = _mm256_max_pd(_mm256_loadu_pd(p + i + 4), m1);
+   }
+   if (i + 4 <= n) {
+      m0 = _mm256_max_pd(_mm256_loadu_pd(p + i), m0);
+      i += 4;
+   }
+   m0 = _mm256_max_pd(m1, m0);
+   m = _mm_max_pd(_mm256_extractf128_pd(m0, 1), _mm256_castpd256_pd128(m0));
+   _mm_storeu_pd(tmp, m);
+   max = tmp[1] > tmp[0] ? tmp[1] : tmp[0];
+   for (; i < n; i++) {
+      double v = probas_at(p, i);
+      if (v > max) {
+         max = v;
+      }
+   }
+   return max;
+}
+
+__attribute__((target("avx2")))
+static double probas_margin_avx2(const double *p, size_t n)
+{
+   __m256d a1 = _mm256_setzero_pd();
+   __m256d a2 = _mm256_setzero_pd();
+   __m256d b1 = _mm256_setzero_pd();
+   __m256d b2 = _mm256_setzero_pd();
+   double l1[8];
+   double l2[8];
+   double m1 = 0;
+   double m2 = 0;
+   size_t i = 0;
+
+   for (; i + 8 <= n; i += 8) {
+      __m256d x = _mm256_loadu_pd(p + i);
+      __m256d y = _mm256_loadu_pd(p + i + 4);
+      a2 = _mm256_max_pd(_mm256_min_pd(a1, x), a2);
+      a1 = _mm256_max_pd(x, a1);
+      b2 = _mm256_max_pd(_mm256_min_pd(b1, y), b2);
+      b1 = _mm256_max_pd(y, b1);
+   }
+   _mm256_storeu_pd(l1, a1);
+   _mm256_storeu_pd(l1 + 4, b1);
+   _mm256_storeu_pd(l2, a2);
+   _mm256_storeu_pd(l2 + 4, b2);
+   probas_top2_lanes(&m1, &m2, l1, l2, 8);
+   for (; i < n; i++) {
+      probas_top2_add(&m1, &m2, probas_at(p, i));
+   }
+   return m1 - m2;
+}
+
+/*!
+ * \brief Vector ln(x) for four positive doubles, see probas_log().
+ */
+__attribute__((target("avx2")))
+static inline __m256d probas_log_avx2(__m256d x)
+{
+   __m256i bits = _mm256_castpd_si256(x);
+   __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(PROBAS_MANT_MASK)), _mm256_set1_epi64x(PROBAS_ONE_BITS)));
+   __m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(PROBAS_2P52_BITS))), _mm256_set1_pd(PROBAS_2P52 + 1023));
+   __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(PROBAS_SQRT2), _CMP_GT_OQ);
+   __m256d one = _mm256_set1_pd(1.0);
+   __m256d f, f2, r;
+
+   m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+   e = _mm256_add_pd(e, _mm256_and_pd(big, one));
+   f = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+   f2 = _mm256_mul_pd(f, f);
+   r = _mm256_add_pd(_mm256_set1_pd(2.0 / 5), _mm256_mul_pd(f2, _mm256_set1_pd(2.0 / 7)));
+   r = _mm256_add_pd(_mm256_set1_pd(2.0 / 3), _mm256_mul_pd(f2, r));
+   r = _mm256_add_pd(_mm256_set1_pd(2.0), _mm256_mul_pd(f2, r));
+   return _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(PROBAS_LN2)), _mm256_mul_pd(f, r));
+}
+
+__attribute__((target("avx2")))
+static double probas_entropy_avx2(const double *p, size_t n)
+{
+   __m256d s0 = _mm256_setzero_pd();
+   __m128d s;
+   double tmp[2];
+   double sum;
+   size_t i = 0;
+
+   for (; i + 4 <= n; i += 4) {
+      __m256d x = _mm256_loadu_pd(p + i);
+      __m256d pos = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ);
+      s0 = _mm256_add_pd(s0, _mm256_and_pd(pos, _mm256_mul_pd(x, probas_log_avx2(x))));
+   }
+   s = _mm_add_pd(_mm256_extractf128_pd(s0, 1), _mm256_castpd256_pd128(s0));
+   _mm_storeu_pd(tmp, s);
+   sum = -(tmp[0] + tmp[1]);
+   for (; i < n; i++) {
+      double v = probas_at(p, i);
+      if (v > 0) {
+         sum -= v * probas_log(v);
+      }
+   }
+   return sum;
+}
+
+__attribute__((target("avx512f")))
+static double probas_max_avx512(const double *p, size_t n)
+{
+   __m512d m0 = _mm512_setzero_pd();
+   __m512d m1 = _mm512_setzero_pd();
+   size_t i = 0;
+
+   for (; i + 16 <= n; i += 16) {
+      m0 = _mm512_max_pd(_mm512_loadu_pd(p + i), m0);
+      m1 = _mm512_max_pd(_mm512_loadu_pd(p + i + 8), m1);
+   }
+   for (; i < n; i += 8) {
+      // masked-off lanes are zero, which is neutral for max >= 0
+      __mmask8 mask = n - i >= 8 ? 0xff : (__mmask8)((1u << (n - i)) - 1);
+      m0 = _mm512_max_pd(_mm512_maskz_loadu_pd(mask, p + i), m0);
+   }
+   return _mm512_reduce_max_pd(_mm512_max_pd(m1, m0));
+}
+
+__attribute__((target("avx512f")))
+static double probas_margin_avx512(const double *p, size_t n)
+{
+   __m512d a1 = _mm512_setzero_pd();
+   __m512d a2 = _mm512_setzero_pd();
+   double l1[8];
+   double l2[8];
+   double m1 = 0;
+   double m2 = 0;
+   size_t i = 0;
+
+   for (; i < n; i += 8) {
+      // masked-off lanes are zero, which is neutral for top-2 >= 0
+      __mmask8 mask = n - i >= 8 ? 0xff : (__mmask8)((1u << (n - i)) - 1);
+      __m512d x = _mm512_maskz_loadu_pd(mask, p + i);
+      a2 = _mm512_max_pd(_mm512_min_pd(a1, x), a2);
+      a1 = _mm512_max_pd(x, a1);
+   }
+   _mm512_storeu_pd(l1, a1);
+   _mm512_storeu_pd(l2, a2);
+   probas_top2_lanes(&m1, &m2, l1, l2, 8);
+   return m1 - m2;
+}
+
+/*!
+ * \brief Vector ln(x) for eight positive doubles, see probas_log().
+ */
+__attribute__((target("avx512f")))
+static inline __m512d probas_log_avx512(__m512d x)
+{
+   __m512i bits = _mm512_castpd_si512(x);
+   __m512d m = _mm512_castsi512_pd(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi64(PROBAS_MANT_MASK)), _mm512_set1_epi64(PROBAS_ONE_BITS)));
+   __m512d e = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(_mm512_srli_epi64(bits, 52), _mm512_set1_epi64(PROBAS_2P52_BITS))), _mm512_set1_pd(PROBAS_2P52 + 1023));
+   __mmask8 big = _mm512_cmp_pd_mask(m, _mm512_set1_pd(PROBAS_SQRT2), _CMP_GT_OQ);
+   __m512d one = _mm512_set1_pd(1.0);
+   __m512d f, f2, r;
+
+   m = _mm512_mask_mul_pd(m, big, m, _mm512_set1_pd(0.5));
+   e = _mm512_mask_add_pd(e, big, e, one);
+   f = _mm512_div_pd(_mm512_sub_pd(m, one), _mm512_add_pd(m, one));
+   f2 = _mm512_mul_pd(f, f);
+   r = _mm512_add_pd(_mm512_set1_pd(2.0 / 5), _mm512_mul_pd(f2, _mm512_set1_pd(2.0 / 7)));
+   r = _mm512_add_pd(_mm512_set1_pd(2.0 / 3), _mm512_mul_pd(f2, r));
+   r = _mm512_add_pd(_mm512_set1_pd(2.0), _mm512_mul_pd(f2, r));
+   return _mm512_add_pd(_mm512_mul_pd(e, _mm512_set1_pd(PROBAS_LN2)), _mm512_mul_pd(f, r));
+}
+
+__attribute__((target("avx512f")))
+static double probas_entropy_avx512(const double *p, size_t n)
+{
+   __m512d s0 = _mm512_setzero_pd();
+   size_t i = 0;
+
+   for (; i < n; i += 8) {
+      __mmask8 mask = n - i >= 8 ? 0xff : (__mmask8)((1u << (n - i)) - 1);
+      __m512d x = _mm512_maskz_loadu_pd(mask, p + i);
+      __mmask8 pos = _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_GT_OQ);
+      s0 = _mm512_mask_add_pd(s0, pos, s0, _mm512_mul_pd(x, probas_log_avx512(x)));
+   }
+   return -_mm512_reduce_add_pd(s0);
+}
+
+#endif /* PROBAS_X86 */
+
+const char *probas_init(void)
+{
+#ifdef PROBAS_X86
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx512f")) {
+      probas_max = &probas_max_avx512;
+      probas_margin = &probas_margin_avx512;
+      probas_entropy = &probas_entropy_avx512;
+      return "avx512";
+   }
+   if (__builtin_cpu_supports("avx2")) {
+      probas_max = &probas_max_avx2;
+      probas_margin = &probas_margin_avx2;
+      probas_entropy = &probas_entropy_avx2;
+      return "avx2";
+   }
+   if (__builtin_cpu_supports("sse2")) {
+      probas_max = &probas_max_sse2;
+      probas_margin = &probas_margin_sse2;
+      probas_entropy = &probas_entropy_sse2;
+      return "sse2";
+   }
+#endif
+   probas_max = &probas_max_scalar;
+   probas_margin = &probas_margin_scalar;
+   probas_entropy = &probas_entropy_scalar;
+   return "scalar";
+}
@@ -0,0 +1,142 @@
+/*!
+ * \file probas.h
+ * \brief Kernels for reduction of probability arrays
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _PROBAS_H_
+#define _PROBAS_H_
+
+#include <stddef.h>
+#include <string.h>
+
+/*!
+ * \brief Load element of probability array.
+ * Arrays are read in place from UniRec records, which start at arbitrary
+ * offsets, so elements are not necessarily 8B aligned. Kernels load through
+ * this function (or unaligned vector loads) only.
+ * \param[in] p Array.
+ * \param[in] i Index of element.
+ * \return Element i.
+ */
+static inline double probas_at(const double *p, size_t i)
+{
+   double v;
+   memcpy(&v, (const char *)p + i * sizeof(v), sizeof(v));
+   return v;
+}
+
+/*!
+ * \brief Max kernel type.
+ * Returns max(0, p[0], ..., p[n-1]), NaN elements are ignored.
+ */
+typedef double (*probas_max_fnc_t)(const double *p, size_t n);
+
+/*!
+ * \brief Margin kernel type.
+ * Returns difference of the two largest of 0, 0, p[0], ..., p[n-1], NaN
+ * elements are ignored.
+ */
+typedef double (*probas_margin_fnc_t)(const double *p, size_t n);
+
+/*!
+ * \brief Entropy kernel type.
+ * Returns Shannon entropy -sum(p[i] * ln(p[i])) in nats, elements which are
+ * not positive are skipped. Logarithm is approximated (relative error below 1e-7).
+ */
+typedef double (*probas_entropy_fnc_t)(const double *p, size_t n);
+
+/*!
+ * \brief Max kernel selected by probas_init().
+ * All kernels return bit-identical results, max does not depend on order.
+ */
+extern probas_max_fnc_t probas_max;
+
+/*!
+ * \brief Margin kernel selected by probas_init().
+ * All kernels return bit-identical results, top-2 does not depend on order.
+ */
+extern probas_margin_fnc_t probas_margin;
+
+/*!
+ * \brief Entropy kernel selected by probas_init().
+ * Order of additions depends on kernel.
+ */
+extern probas_entropy_fnc_t probas_entropy;
+
+/*!
+ * \brief Select the best kernels for the host CPU.
+ * Scalar kernels are used until this function is called and on CPUs
+ * without SIMD support.
+ * \return Name of selected kernel set ("scalar", "sse2", "avx2" or "avx512").
+ */
+const char *probas_init(void);
+
+/*!
+ * \brief Scalar max kernel.
+ * \param[in] p Array of probabilities.
+ * \param[in] n Number of elements.
+ * \return Max element, at least 0.
+ */
+double probas_max_scalar(const double *p, size_t n);
+
+/*!
+ * \brief Scalar margin kernel.
+ * \param[in] p Array of probabilities.
+ * \param[in] n Number of elements.
+ * \return Largest minus second largest element, both at least 0.
+ */
+double probas_margin_scalar(const double *p, size_t n);
+
+/*!
+ * \brief Scalar entropy kernel.
+ * \param[in] p Array of probabilities.
+ * \param[in] n Number of elements.
+ * \return Entropy in nats.
+ */
+double probas_entropy_scalar(const double *p, size_t n);
+
+/*!
+ * \brief Natural logarithm approximation used by entropy kernels.
+ * \param[in] x Positive normal number.
+ * \return Approximation of ln(x).
+ */
+double probas_log(double x);
+
+#endif /* _PROBAS_H_ */
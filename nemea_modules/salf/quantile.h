@@ -0,0 +1,179 @@
+/*!
+ * \file quantile.h
+ * \brief Streaming quantile estimation (P-square algorithm)
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _QUANTILE_H_
+#define _QUANTILE_H_
+
+#include <stdint.h>
+
+/*
+ * P-square algorithm (Jain, Chlamtac 1985): the p-quantile is tracked by five
+ * markers (min, p/2, p, (1+p)/2, max) whose heights are adjusted by piecewise
+ * parabolic interpolation. Memory is constant and update is a few compares
+ * and one interpolation, so it can run on every record.
+ *
+ * Marker positions are halved when the stream grows over the forget window,
+ * so the estimate follows shifts of the distribution instead of converging
+ * to the quantile of the whole history.
+ */
+
+/*!
+ * \brief State of quantile estimator.
+ */
+typedef struct p2_s {
+   double q[5]; /*< Heights of markers. */
+   double n[5]; /*< Actual positions of markers. */
+   double np[5]; /*< Desired positions of markers. */
+   double dn[5]; /*< Increments of desired positions. */
+   double p; /*< Estimated quantile. */
+   double window; /*< Positions are halved when the last marker reaches it, 0 to keep whole history. */
+   uint32_t cnt; /*< Number of observations, up to 5 (initialization). */
+} p2_t;
+
+/*!
+ * \brief Initialize estimator.
+ * \param[out] e Estimator.
+ * \param[in] p Quantile, in interval (0,1).
+ * \param[in] window Forget window in observations, 0 to keep whole history.
+ */
+static inline void p2_init(p2_t *e, double p, double window)
+{
+   e->p = p;
+   e->window = window;
+   e->cnt = 0;
+   e->dn[0] = 0;
+   e->dn[1] = p / 2;
+   e->dn[2] = p;
+   e->dn[3] = (1 + p) / 2;
+   e->dn[4] = 1;
+}
+
+/*!
+ * \brief Adjust height of marker i by d (+1 or -1) positions.
+ */
+static inline double p2_height(const p2_t *e, int i, double d)
+{
+   const double *q = e->q;
+   const double *n = e->n;
+   double qp = q[i] + d / (n[i + 1] - n[i - 1]) *
+      ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+       (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+
+   if (q[i - 1] < qp && qp < q[i + 1]) {
+      return qp;
+   }
+   // parabolic prediction out of order, use linear one
+   return q[i] + d * (q[i + (int)d] - q[i]) / (n[i + (int)d] - n[i]);
+}
+
+/*!
+ * \brief Add observation.
+ * \param[in,out] e Estimator.
+ * \param[in] x Observation.
+ */
+static inline void p2_add(p2_t *e, double x)
+{
+   int i, k;
+
+   if (e->cnt < 5) {
+      // keep first observations sorted
+      for (i = (int)e->cnt; i > 0 && e->q[i - 1] > x; i--) {
+         e->q[i] = e->q[i - 1];
+      }
+      e->q[i] = x;
+      if (++e->cnt == 5) {
+         for (i = 0; i < 5; i++) {
+            e->n[i] = i;
+         }
+         e->np[0] = 0;
+         e->np[1] = 2 * e->p;
+         e->np[2] = 4 * e->p;
+         e->np[3] = 2 + 2 * e->p;
+         e->np[4] = 4;
+      }
+      return;
+   }
+
+   if (x < e->q[0]) {
+      e->q[0] = x;
+      k = 0;
+   } else if (x >= e->q[4]) {
+      e->q[4] = x;
+      k = 3;
+   } else {
+      for (k = 0; x >= e->q[k + 1]; k++) {
+      }
+   }
+   for (i = k + 1; i < 5; i++) {
+      e->n[i]++;
+   }
+   for (i = 0; i < 5; i++) {
+      e->np[i] += e->dn[i];
+   }
+   for (i = 1; i < 4; i++) {
+      double d = e->np[i] - e->n[i];
+      if ((d >= 1 && e->n[i + 1] - e->n[i] > 1) || (d <= -1 && e->n[i - 1] - e->n[i] < -1)) {
+         d = d > 0 ? 1 : -1;
+         e->q[i] = p2_height(e, i, d);
+         e->n[i] += d;
+      }
+   }
+   if (e->window > 0 && e->n[4] >= e->window) {
+      for (i = 0; i < 5; i++) {
+         e->n[i] /= 2;
+         e->np[i] /= 2;
+      }
+   }
+}
+
+/*!
+ * \brief Current estimate.
+ * \param[in] e Estimator.
+ * \param[in] dflt Value returned before five observations are seen.
+ * \return Estimate of the quantile.
+ */
+static inline double p2_get(const p2_t *e, double dflt)
+{
+   return e->cnt < 5 ? dflt : e->q[2];
+}
+
+#endif /* _QUANTILE_H_ */
@@ -0,0 +1,168 @@
+/*!
+ * \file rng.c
+ * \brief Fast seedable pseudo-random number generator
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "rng.h"
+#include <math.h>
+
+/*!
+ * \name Ziggurat parameters
+ * 128 layers, Doornik: An Improved Ziggurat Method to Generate Normal Random Samples.
+ * \{ */
+#define ZIG_C 128 /*< Number of layers. */
+#define ZIG_R 3.442619855899 /*< Start of the tail. */
+#define ZIG_V 9.91256303526217e-3 /*< Area of every layer. */
+/*! \} */
+
+static double zig_x[ZIG_C + 1];
+static double zig_r[ZIG_C];
+
+void rng_init(void)
+{
+   double f = exp(-0.5 * ZIG_R * ZIG_R);
+   int i;
+
+   zig_x[0] = ZIG_V / f; // bottom layer including the tail
+   zig_x[1] = ZIG_R;
+   zig_x[ZIG_C] = 0;
+   for (i = 2; i < ZIG_C; i++) {
+      zig_x[i] = sqrt(-2 * log(ZIG_V / zig_x[i - 1] + f));
+      f = exp(-0.5 * zig_x[i] * zig_x[i]);
+   }
+   for (i = 0; i < ZIG_C; i++) {
+      zig_r[i] = zig_x[i + 1] / zig_x[i];
+   }
+}
+
+static uint64_t splitmix64(uint64_t *x)
+{
+   uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+   return z ^ (z >> 31);
+}
+
+void rng_seed(rng_t *rng, uint64_t seed, uint64_t stream)
+{
+   uint64_t x = seed;
+   uint64_t y = stream;
+   int i, l;
+
+   x ^= splitmix64(&y);
+   for (l = 0; l < RNG_LANES; l++) {
+      for (i = 0; i < 4; i++) {
+         rng->s[i][l] = splitmix64(&x);
+      }
+   }
+   rng->pos = RNG_BLOCK;
+}
+
+#define ROTL(x, k) (((x) << (k)) | ((x) >> (64 - (k))))
+
+void rng_fill_u64(rng_t *rng, uint64_t *out, size_t n)
+{
+   uint64_t s0[RNG_LANES], s1[RNG_LANES], s2[RNG_LANES], s3[RNG_LANES];
+   size_t i;
+   int l;
+
+   for (l = 0; l < RNG_LANES; l++) {
+      s0[l] = rng->s[0][l];
+      s1[l] = rng->s[1][l];
+      s2[l] = rng->s[2][l];
+      s3[l] = rng->s[3][l];
+   }
+   for (i = 0; i < n; i += RNG_LANES) {
+      // lanes are independent, the loop below is vectorized
+      for (l = 0; l < RNG_LANES; l++) {
+         uint64_t r = s1[l] * 5;
+         uint64_t t = s1[l] << 17;
+         out[i + l] = ROTL(r, 7) * 9;
+         s2[l] ^= s0[l];
+         s3[l] ^= s1[l];
+         s1[l] ^= s2[l];
+         s0[l] ^= s3[l];
+         s2[l] ^= t;
+         s3[l] = ROTL(s3[l], 45);
+      }
+   }
+   for (l = 0; l < RNG_LANES; l++) {
+      rng->s[0][l] = s0[l];
+      rng->s[1][l] = s1[l];
+      rng->s[2][l] = s2[l];
+      rng->s[3][l] = s3[l];
+   }
+}
+
+static double rng_normal_tail(rng_t *rng, double min, int negative)
+{
+   double x, y;
+   do {
+      x = log(rng_uniform_pos(rng)) / min;
+      y = log(rng_uniform_pos(rng));
+   } while (-2 * y < x * x);
+   return negative ? x - min : min - x;
+}
+
+double rng_normal(rng_t *rng, double mu, double sigma)
+{
+   for (;;) {
+      uint64_t r = rng_u64(rng);
+      // top 53 bits for position inside the layer, low 7 bits for the layer
+      double u = 2 * ((double)(r >> 11) * 0x1.0p-53) - 1;
+      unsigned int i = r & (ZIG_C - 1);
+      double x, f0, f1;
+
+      // inside the rectangle of the layer, the fast path
+      if (fabs(u) < zig_r[i]) {
+         return mu + sigma * u * zig_x[i];
+      }
+      if (i == 0) {
+         return mu + sigma * rng_normal_tail(rng, ZIG_R, u < 0);
+      }
+      // wedge between the rectangle and the density
+      x = u * zig_x[i];
+      f0 = exp(-0.5 * (zig_x[i] * zig_x[i] - x * x));
+      f1 = exp(-0.5 * (zig_x[i + 1] * zig_x[i + 1] - x * x));
+      if (f1 + rng_uniform(rng) * (f0 - f1) < 1.0) {
+         return mu + sigma * x;
+      }
+   }
+}
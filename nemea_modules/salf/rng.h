@@ -0,0 +1,146 @@
+/*!
+ * \file rng.h
+ * \brief Fast seedable pseudo-random number generator
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _RNG_H_
+#define _RNG_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * \name RNG parameters
+ * \{ */
+#define RNG_LANES 4 /*< Number of interleaved xoshiro256** streams (vectorized refill). */
+#define RNG_BLOCK 256 /*< Number of 64-bit numbers generated in one block. */
+/*! \} */
+
+/*!
+ * \brief Generator state.
+ * Every thread has to use its own state. Numbers are generated in blocks of
+ * RNG_BLOCK by RNG_LANES independent xoshiro256** streams, so that refill
+ * of the block is vectorized by compiler, and consumed one by one.
+ */
+typedef struct rng_s {
+   uint64_t s[4][RNG_LANES]; /*< xoshiro256** state, one column per lane. */
+   uint64_t buf[RNG_BLOCK]; /*< Generated block. */
+   size_t pos; /*< Next unused number in block. */
+} rng_t;
+
+/*!
+ * \brief Initialize tables of ziggurat normal sampler.
+ * Must be called once before rng_normal() is used.
+ */
+void rng_init(void);
+
+/*!
+ * \brief Seed generator.
+ * Generators with the same seed and different stream produce independent sequences.
+ * \param[out] rng Generator.
+ * \param[in] seed Seed.
+ * \param[in] stream Stream ID (e.g. thread number).
+ */
+void rng_seed(rng_t *rng, uint64_t seed, uint64_t stream);
+
+/*!
+ * \brief Generate block of 64-bit numbers.
+ * \param[in] rng Generator.
+ * \param[out] out Output array.
+ * \param[in] n Number of elements, must be a multiple of RNG_LANES.
+ */
+void rng_fill_u64(rng_t *rng, uint64_t *out, size_t n);
+
+/*!
+ * \brief Normal distribution (ziggurat method).
+ * \param[in] rng Generator.
+ * \param[in] mu Mean.
+ * \param[in] sigma Standard deviation.
+ * \return Random number.
+ */
+double rng_normal(rng_t *rng, double mu, double sigma);
+
+/*!
+ * \brief Random 64-bit number.
+ * \param[in] rng Generator.
+ * \return Random number.
+ */
+static inline uint64_t rng_u64(rng_t *rng)
+{
+   if (rng->pos == RNG_BLOCK) {
+      rng_fill_u64(rng, rng->buf, RNG_BLOCK);
+      rng->pos = 0;
+   }
+   return rng->buf[rng->pos++];
+}
+
+/*!
+ * \brief Uniform distribution on [0,1).
+ * \param[in] rng Generator.
+ * \return Random number.
+ */
+static inline double rng_uniform(rng_t *rng)
+{
+   return (double)(rng_u64(rng) >> 11) * 0x1.0p-53;
+}
+
+/*!
+ * \brief Uniform distribution on (0,1], safe for log().
+ * \param[in] rng Generator.
+ * \return Random number.
+ */
+static inline double rng_uniform_pos(rng_t *rng)
+{
+   return (double)((rng_u64(rng) >> 11) + 1) * 0x1.0p-53;
+}
+
+/*!
+ * \brief Uniform integer from [0,n).
+ * Multiply-shift mapping of 64-bit number, bias is below n / 2^64.
+ * \param[in] rng Generator.
+ * \param[in] n Number of values.
+ * \return Random number.
+ */
+static inline uint64_t rng_below(rng_t *rng, uint64_t n)
+{
+   return (uint64_t)(((unsigned __int128)rng_u64(rng) * n) >> 64);
+}
+
+#endif /* _RNG_H_ */
@@ -42,6 +42,12 @@
  */
 
 #include "salf.h"
+#include "probas.h"
+#include "fvec.h"
+#include "rng.h"
+#include "strategy.h"
+#include "pool.h"
+#include "checkpoint.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -52,170 +58,605 @@ trap_module_info_t *module_info = NULL;
 
 #define MODULE_PARAMS(PARAM) \
 PARAM('b', "budget", "Every strategy is limited by budget. This parameter specifies the budget. This number should be in interval [0,1] and it is interpreted as percentage of the data.", required_argument, "int32") \
-PARAM('q', "query-strategy", "Number of the query strategy to be used.  0 - Random Strategy  1 -  Fixed Uncertainty Strategy 2 - Variable Uncertainty Strategy  3 -  Uncertainty Strategy with Randomization", required_argument, "int32") \
+PARAM('q', "query-strategy", "Number of the query strategy to be used.  0 - Random Strategy  1 -  Fixed Uncertainty Strategy 2 - Variable Uncertainty Strategy  3 -  Uncertainty Strategy with Randomization  4 - PI Controller  5 - Margin  6 - Entropy  7 - Query by Committee  8 - Top-k Window  9 - Reservoir Window  10 - Flow Hash  11 - Diversity", required_argument, "int32") \
 PARAM('t', "threshold", "labeling threshold for Fixed uncertainty strategy", required_argument, "double")\
+PARAM('g', "kp", "Proportional gain of PI controller (strategy 4, default 0.5).", required_argument, "double")\
+PARAM('G', "ki", "Integral gain of PI controller (strategy 4, default 0.001).", required_argument, "double")\
+PARAM('W', "window", "Number of last flows the budget of strategies 2, 3 and 4 is checked over (default 32768, max 65536).", required_argument, "int32")\
+PARAM('m', "committee", "Comma separated names of probability arrays of committee members (strategy 7), e.g. 'PROBAS_RF,PROBAS_NN,PROBAS_KNN' (2 to 16 fields of type double*).", required_argument, "string")\
+PARAM('e', "committee-measure", "Disagreement of committee used by strategy 7. 0 - vote entropy (default), 1 - mean KL divergence from consensus.", required_argument, "int32")\
+PARAM('y', "stratify", "Split budget among classes predicted by PREDICTED_PROBAS. 0 - shared budget (default), 1 - uniform, 2 - inverse class frequency.", required_argument, "int32")\
+PARAM('K', "select-k", "Number of records selected per window by strategies 8 and 9 (default 0, i.e. budget * records per window).", required_argument, "int32")\
+PARAM('N', "select-window", "Number of records per window of strategies 8 and 9 (default 10000, 0 for time windows only, which need -K).", required_argument, "int32")\
+PARAM('I', "select-interval", "Max duration of window of strategies 8 and 9 in seconds, bounds the forwarding latency (default 1, 0 for count windows only).", required_argument, "double")\
+PARAM('x', "hash-key", "Fields of flow key of strategy 10, sum of 1 - SRC_IP, 2 - DST_IP, 4 - SRC_PORT, 8 - DST_PORT, 16 - PROTOCOL (default 31).", required_argument, "int32")\
+PARAM('o', "hash-oneway", "Flow key of strategy 10 keeps direction, the two directions of a session are selected independently.", no_argument, "none")\
+PARAM('u', "dedup", "Max number of labeled flows of one endpoint pair (SRC_IP, DST_IP, DST_PORT) within the half-life, further flows of the pair are not offered to strategy (default 0, not limited).", required_argument, "int32")\
+PARAM('l', "dedup-halflife", "Half-life of label counts of endpoint pairs in seconds (default 60).", required_argument, "double")\
+PARAM('H', "host-share", "Max fraction of labeled flows of one source host (SRC_IP) within the host window, further flows of the host are not offered to strategy (default 0, not limited).", required_argument, "double")\
+PARAM('J', "host-window", "Number of labeled flows in window of the per-host cap (default 1000).", required_argument, "int32")\
+PARAM('F', "features", "Comma separated names of numeric feature fields, e.g. 'BYTES,PACKETS,DURATION' (at most 16 fields of integer or floating point type).", required_argument, "string")\
+PARAM('C', "clusters", "Number of online k-means clusters of feature fields used by strategy 11 (default 16, at most 64).", required_argument, "int32")\
+PARAM('L', "lsh-bands", "Number of bands of SimHash signature of features (1, 2, 4 or 8), flows sharing a band with a recently labeled flow are not offered to strategy (default 0, off).", required_argument, "int32")\
+PARAM('T', "lsh-ttl", "Time signatures of labeled flows suppress near-duplicates in seconds (default 1, 0 until overwritten).", required_argument, "double")\
+PARAM('a', "auto-threshold", "Fixed uncertainty strategy sets its threshold to the budget quantile of max probabilities (streaming estimate), -t is used only for the first records.", no_argument, "none")\
 PARAM('s', "step", "adjusting step", required_argument, "double")\
 PARAM('d', "deviation", "Standard deviation of the threshold randomization used in Uncertainty Strategy with Randomization", required_argument, "double")\
-PARAM('n', "no-eof", "Do not send terminate message vie output IFC.", no_argument, "none")
+PARAM('r', "rate", "Max number of labeled flows per second (token bucket), applied together with budget (default 0, unlimited).", required_argument, "double")\
+PARAM('R', "burst", "Number of flows which can be labeled at once when rate is limited (default is rate, i.e. one second).", required_argument, "double")\
+PARAM('n', "no-eof", "Do not send terminate message vie output IFC.", no_argument, "none")\
+PARAM('S', "seed", "Seed of the random number generator (default is current time).", required_argument, "uint64")\
+PARAM('B', "batch", "Number of records received, decided and sent in one batch (default 1, i.e. record by record).", required_argument, "int32")\
+PARAM('c', "config", "Strategy configuration bound to the next output interface, e.g. 'q=2,b=0.05,s=0.2' (keys q, b, t, s, d, r, R, a, g, G, W, e, y, x, o, u, l, L, T, C as the options of the same letter, k, n, i, h, j as -K, -N, -I, -H, -J; a and o take 0 or 1). May be given multiple times, every record is then evaluated by all configurations.", required_argument, "string")\
+PARAM('f', "params-file", "File with strategy configurations, one per output interface and line (format of -c). Loaded at start and reloaded on SIGHUP without restart.", required_argument, "string")\
+PARAM('k', "state-file", "File keeping adaptive state of strategies (threshold, budget counters) across restarts.", required_argument, "string")\
+PARAM('P', "backpressure", "Max duration of sending one batch in microseconds. Slower sends (or send timeouts) reduce the fraction of flows offered to strategies until the consumer catches up; output interfaces time out after this duration (default 0, disabled).", required_argument, "int32")\
+PARAM('w', "workers", "Number of worker threads running the strategy (default 0, i.e. strategy runs in the receiving thread).", required_argument, "int32")
 
 
 
 
 static char stop = 0; /*!< Global variable used by signal handler to end the traffic repeater. */
+static volatile sig_atomic_t reload = 0; /*< Set by SIGHUP, strategy parameters are reloaded. */
+static const char *params_file = NULL; /*< File with strategy parameters. */
+static const char *state_file = NULL; /*< File with persistent state of strategies. */
+static uint64_t backpressure_us = 0; /*< Max duration of batch send before throttling, 0 if disabled. */
+static const char *committee_names[SALF_COMMITTEE_MAX]; /*< Names of probability arrays of committee members. */
+static size_t committee_cnt = 0; /*< Number of committee members. */
+static const char *features_names[SALF_FEATURES_MAX]; /*< Names of numeric feature fields. */
+static size_t features_cnt = 0; /*< Number of feature fields. */
 static int verb = 0; /*< Global variable used to print verbose messages. */
 static char sendeof = 1;
 
-static double budget = 0.5;
-static double labeling_threshold = 0.5;
-static double step = 0.4;
-static double t_deviation = 1; 
 
 TRAP_DEFAULT_SIGNAL_HANDLER(stop = 1)
 
-double get_uniform_random() { return (double)rand() / (double)RAND_MAX; }
+static void salf_sighup_handler(int signal)
+{
+   (void)signal;
+   reload = 1;
+}
 
-double normal_distribution(double mu, double sigma)
+/*!
+ * \brief Current monotonic time.
+ * \return Time in ns.
+ */
+static uint64_t salf_now_ns(void)
 {
-  double U1, U2, W, mult;
-  static double X1, X2;
-  static int call = 0;
-  
-  if (call == 1)
-    {
-      call = !call;
-      return (mu + sigma * (double) X2);
-    }
- 
-  do
-    {
-      U1 = -1 + ((double) rand () / RAND_MAX) * 2;
-      U2 = -1 + ((double) rand () / RAND_MAX) * 2;
-      W = pow (U1, 2) + pow (U2, 2);
-    }
-  while (W >= 1 || W == 0);
- 
-  mult = sqrt ((-2 * log (W)) / W);
-  X1 = U1 * mult;
-  X2 = U2 * mult;
- 
-  call = !call;
- 
-  return (mu + sigma * (double) X1);
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * NS + now.tv_nsec;
 }
 
- 
+int salf_batch_init(salf_batch_t *batch, size_t capacity, size_t nout)
+{
+   memset(batch, 0, sizeof(*batch));
+   batch->cap = capacity;
+   batch->nout = nout;
+   batch->throttle = 1.0;
+   batch->arena_size = capacity * SALF_BATCH_ARENA_REC;
+   if (batch->arena_size < SALF_BATCH_ARENA_MIN) {
+      batch->arena_size = SALF_BATCH_ARENA_MIN;
+   }
+   batch->arena = malloc(batch->arena_size);
+   batch->rec = malloc(capacity * sizeof(*batch->rec));
+   batch->size = malloc(capacity * sizeof(*batch->size));
+   batch->decision = malloc(nout * capacity * sizeof(*batch->decision));
+   batch->maxp = malloc(capacity * sizeof(*batch->maxp));
+   if (batch->arena == NULL || batch->rec == NULL || batch->size == NULL || batch->decision == NULL || batch->maxp == NULL) {
+      salf_batch_free(batch);
+      return 1;
+   }
+   return 0;
+}
 
-double get_max(const void *data,ur_template_t * in_tmplt,int fieldID){
-   int size = ur_array_get_elem_cnt(in_tmplt,data,fieldID);
-   if(size <= 0)
-      return 0;
-   double max = 0;
-   double sum = 0;
-   for (size_t i = 0; i < size; i++){
-      double tmp = ((double *)((char *)(ur_get_ptr_by_id(in_tmplt, data, fieldID))))[i]; // == ur_array_get(in_tmplt,data,fieldID,i);
-      if(tmp > max)
-         max = tmp;
-      sum += tmp;
-      if((1 - sum) < max)
-         break;
+void salf_batch_free(salf_batch_t *batch)
+{
+   free(batch->arena);
+   free(batch->rec);
+   free(batch->size);
+   free(batch->decision);
+   free(batch->maxp);
+   salf_release_free(&batch->release);
+   memset(batch, 0, sizeof(*batch));
+}
+
+int salf_batch_push(salf_batch_t *batch, const void *data, uint16_t data_size)
+{
+   if (batch->cnt >= batch->cap || batch->arena_used + data_size > batch->arena_size) {
+      return 1;
+   }
+   char *dst = batch->arena + batch->arena_used;
+   memcpy(dst, data, data_size);
+   batch->rec[batch->cnt] = dst;
+   batch->size[batch->cnt] = data_size;
+   batch->cnt++;
+   // records start 8B aligned, array fields inside them still may not be (see probas_at())
+   batch->arena_used += (data_size + 7) & ~(size_t)7;
+   return 0;
+}
+
+int salf_batch_send(salf_batch_t *batch, salf_stats_t *stats)
+{
+   size_t i, k;
+   int ret;
+   uint64_t sent = stats->cnt_s + stats->send_t;
+   uint64_t start = salf_now_ns();
+
+   for (k = 0; k < batch->nout; k++) {
+      const char *decision = batch->decision + k * batch->cap;
+      for (i = 0; i < batch->cnt; i++) {
+         if (!decision[i]) {
+            continue;
+         }
+         ret = trap_send(k, batch->rec[i], batch->size[i]);
+         if (ret == TRAP_E_OK) {
+            stats->cnt_s++;
+            stats->sent[k]++;
+            continue;
+         }
+         TRAP_DEFAULT_SEND_DATA_ERROR_HANDLING(ret, stats->cnt_t++; stats->send_t++; continue, batch->cnt = 0; batch->arena_used = 0; salf_release_clear(&batch->release); return 1)
+      }
+      for (i = 0; i < batch->release.cnt; i++) {
+         if (batch->release.out[i] != k) {
+            continue;
+         }
+         ret = trap_send(k, salf_release_rec(&batch->release, i), batch->release.size[i]);
+         if (ret == TRAP_E_OK) {
+            stats->cnt_s++;
+            stats->sent[k]++;
+            continue;
+         }
+         TRAP_DEFAULT_SEND_DATA_ERROR_HANDLING(ret, stats->cnt_t++; stats->send_t++; continue, batch->cnt = 0; batch->arena_used = 0; salf_release_clear(&batch->release); return 1)
+      }
+   }
+
+   if (stats->cnt_s + stats->send_t != sent) {
+      stats->send_ns += salf_now_ns() - start;
+      stats->send_batches++;
+   }
+   batch->cnt = 0;
+   batch->arena_used = 0;
+   batch->flush = 0;
+   salf_release_clear(&batch->release);
+   return 0;
+}
+
+/*!
+ * \brief Strategy parameters loaded by reload.
+ * Batches in flight may still refer to older snapshots, so a snapshot is
+ * freed once the batches dispatched with it are collected.
+ */
+typedef struct salf_params_snapshot_s {
+   struct salf_params_snapshot_s *next; /*< Older snapshot. */
+   unsigned int gen; /*< Generation of parameters. */
+   salf_params_t params[SALF_OUTPUTS_MAX]; /*< Parameters, one per output interface. */
+} salf_params_snapshot_t;
+
+/*!
+ * \brief Processing context of the main loop.
+ */
+typedef struct salf_ctx_s {
+   salf_strategy_set_t set; /*< Strategy instances when running without workers. */
+   size_t nout; /*< Number of output interfaces. */
+   salf_view_t view; /*< Offsets of fields in current format. */
+   salf_committee_t committee; /*< Offsets of committee fields in current format. */
+   salf_features_t features; /*< Offsets of feature fields in current format. */
+   salf_batch_t *batch; /*< Batch being filled. */
+   salf_pool_t *pool; /*< Worker pool, NULL when strategy runs in the main thread. */
+   salf_stats_t stats; /*< Counters. */
+   const salf_params_t *base; /*< Parameters given on command line. */
+   salf_params_snapshot_t *snapshot; /*< Latest reloaded parameters. */
+   unsigned int params_gen; /*< Number of reloads. */
+   uint64_t throttle_ns; /*< Max duration of batch send before throttling, 0 if disabled. */
+   double throttle; /*< Fraction of flows offered to strategies. */
+   double throttle_min; /*< Min throttle level reached. */
+   int windowed; /*< Some strategy is windowed, empty batches are dispatched too (windows close by time). */
+   int resolved; /*< View is resolved from input format. */
+} salf_ctx_t;
+
+/*!
+ * \brief Set timeouts of interfaces.
+ * Input times out when records may wait in the module (incomplete batch,
+ * workers or open windows of windowed strategies), so that they are flushed
+ * when no data arrives. With backpressure, sends time out as well.
+ * Called at start and after reload, which may switch to windowed strategy.
+ * \param[in] ctx Context.
+ */
+static void salf_timeouts_set(const salf_ctx_t *ctx)
+{
+   size_t i;
+
+   if (ctx->pool != NULL || ctx->batch->cap > 1 || ctx->windowed) {
+      // incomplete batch is flushed when no data arrives for a while
+      trap_ifcctl(TRAPIFC_INPUT, 0, TRAPCTL_SETTIMEOUT, SALF_BATCH_TIMEOUT);
+   }
+   if (backpressure_us > 0) {
+      // slow consumer makes sends time out instead of blocking the input
+      for (i = 0; i < ctx->nout; i++) {
+         trap_ifcctl(TRAPIFC_OUTPUT, i, TRAPCTL_SETTIMEOUT, (int)backpressure_us);
+      }
+   }
+}
+
+/*!
+ * \brief Load strategy parameters from params_file.
+ * New parameters are attached to batches handed over for decision from now
+ * on, so every strategy instance switches at a batch boundary and keeps its
+ * adaptive state.
+ * \param[in] ctx Context.
+ * \return 0 on success, 1 on error (old parameters are kept).
+ */
+static int salf_reload(salf_ctx_t *ctx)
+{
+   salf_params_snapshot_t *snapshot = malloc(sizeof(*snapshot));
+   size_t cnt;
+   size_t i;
+
+   if (snapshot == NULL) {
+      return 1;
+   }
+   memcpy(snapshot->params, ctx->base, ctx->nout * sizeof(*snapshot->params));
+   if (salf_params_load(params_file, snapshot->params, SALF_OUTPUTS_MAX, &cnt)) {
+      free(snapshot);
+      return 1;
+   }
+   if (cnt != ctx->nout) {
+      fprintf(stderr, "Error: %s contains %zu configurations, %zu expected (one per output interface).\n", params_file, cnt, ctx->nout);
+      free(snapshot);
+      return 1;
+   }
+   for (i = 0; i < ctx->nout; i++) {
+      if (salf_params_validate(&snapshot->params[i], committee_cnt, features_cnt) ||
+          (ctx->resolved && salf_params_check_view(&snapshot->params[i], &ctx->view))) {
+         fprintf(stderr, "Error: %s: configuration %zu is not valid.\n", params_file, i + 1);
+         free(snapshot);
+         return 1;
+      }
+   }
+   snapshot->next = ctx->snapshot;
+   ctx->snapshot = snapshot;
+   snapshot->gen = ++ctx->params_gen;
+   ctx->windowed |= salf_params_windowed(snapshot->params, ctx->nout);
+   salf_timeouts_set(ctx);
+   return 0;
+}
+
+/*!
+ * \brief Send decided batch and adapt throttle level to backpressure.
+ * Send which timed out or took longer than throttle_ns halves the fraction
+ * of flows offered to strategies, every send without congestion raises it
+ * by SALF_THROTTLE_STEP back to 1 (AIMD). Output interfaces have timeout
+ * throttle_ns, so the receiving thread is never blocked for long.
+ * \param[in] ctx Context.
+ * \param[in] batch Decided batch.
+ * \return 0 on success, 1 on send error.
+ */
+static int salf_send(salf_ctx_t *ctx, salf_batch_t *batch)
+{
+   uint64_t timeouts = ctx->stats.send_t;
+   uint64_t ns = ctx->stats.send_ns;
+   uint64_t batches = ctx->stats.send_batches;
+   int ret = salf_batch_send(batch, &ctx->stats);
+
+   if (ctx->throttle_ns == 0 || ctx->stats.send_batches == batches) {
+      return ret;
+   }
+   if (ctx->stats.send_t != timeouts || ctx->stats.send_ns - ns > ctx->throttle_ns) {
+      ctx->stats.congested++;
+      ctx->throttle *= 0.5;
+      if (ctx->throttle < SALF_THROTTLE_MIN) {
+         ctx->throttle = SALF_THROTTLE_MIN;
+      }
+      if (ctx->throttle < ctx->throttle_min) {
+         ctx->throttle_min = ctx->throttle;
+      }
+   } else if (ctx->throttle < 1.0) {
+      ctx->throttle += SALF_THROTTLE_STEP;
+      if (ctx->throttle > 1.0) {
+         ctx->throttle = 1.0;
+      }
    }
-   return max;
+   return ret;
 }
 
-char random_strategy(const void *data,ur_template_t * in_tmplt,int fieldID){
-   return (get_uniform_random() < budget);
+/*!
+ * \brief Free snapshots older than the given generation.
+ * Batches are dispatched with the latest snapshot and collected in the same
+ * order, so snapshots older than the oldest batch in flight are not referred
+ * to anymore. The latest snapshot is always kept.
+ * \param[in] ctx Context.
+ * \param[in] gen Generation of parameters of the oldest batch in flight.
+ */
+static void salf_snapshot_trim(salf_ctx_t *ctx, unsigned int gen)
+{
+   salf_params_snapshot_t *snapshot = ctx->snapshot;
+   salf_params_snapshot_t *older;
+
+   if (snapshot == NULL) {
+      return;
+   }
+   while (snapshot->next != NULL && snapshot->next->gen >= gen) {
+      snapshot = snapshot->next;
+   }
+   while (snapshot->next != NULL) {
+      older = snapshot->next->next;
+      free(snapshot->next);
+      snapshot->next = older;
+   }
 }
 
-char fixed_uncertainty_strategy(const void *data,ur_template_t * in_tmplt,int fieldID){
-   double probability = get_max(data,in_tmplt,fieldID);
-   return(probability < labeling_threshold);
+/*!
+ * \brief Send batch collected from worker and return it to the worker.
+ * \param[in] ctx Context.
+ * \param[in] done Batch returned by salf_pool_collect().
+ * \return 0 on success, 1 on send error.
+ */
+static int salf_retire(salf_ctx_t *ctx, salf_batch_t *done)
+{
+   int ret = salf_send(ctx, done);
+
+   // batches in flight are newer than the collected one
+   salf_snapshot_trim(ctx, ctx->pool->in_flight > 0 ? done->params_gen : ctx->params_gen);
+   salf_pool_release(ctx->pool, done);
+   return ret;
 }
 
-char variable_uncertainty_strategy(const void *data,ur_template_t * in_tmplt,int fieldID){
-   static double threshold = 1.0;
-   static double u = 1.0;
-   static long t = 0;
-   t++;
-   if(t >= T_MAX){
-      t = 1;
-      u /= T_MAX;
-   }
-
-   if(u/t < budget){
-      double probability = get_max(data,in_tmplt,fieldID);
-      if(probability < threshold){
-         u++;
-         threshold *= 1 - step;
+/*!
+ * \brief Send decided batches returned by workers.
+ * Batches are returned in the same order in which they were received.
+ * \param[in] ctx Context.
+ * \param[in] wait Wait for all batches in flight.
+ * \return 0 on success, 1 on send error.
+ */
+static int salf_collect(salf_ctx_t *ctx, int wait)
+{
+   salf_batch_t *done;
+   int ret;
+
+   while ((done = salf_pool_collect(ctx->pool, wait)) != NULL) {
+      ret = salf_retire(ctx, done);
+      if (ret) {
          return 1;
-      }else{
-         threshold *= step + 1;
-         return 0;
       }
-   }else{
-      return 0;
-   }
-} 
-
-char uncertainty_strategy_with_randomization(const void *data,ur_template_t * in_tmplt,int fieldID){
-   static double threshold = 1.0;
-   static double u = 1.0;
-   static long t = 0;
-   t++;
-   if(t >= T_MAX){
-      t = 1;
-      u /= T_MAX;
-   }
-
-   if(u/t < budget){
-      double probability = get_max(data,in_tmplt,fieldID);
-      if(probability < (threshold * normal_distribution(1,t_deviation))){
-         u++;
-         threshold *= 1 - step;
+   }
+   return 0;
+}
+
+/*!
+ * \brief Decide and send records of current batch.
+ * Without workers the batch is processed immediately. Otherwise it is handed
+ * over to the next worker and an empty batch is taken instead; batches
+ * decided meanwhile are sent.
+ * \param[in] ctx Context.
+ * \return 0 on success, 1 on send error.
+ */
+static int salf_dispatch(salf_ctx_t *ctx)
+{
+   int err = 0;
+
+   ctx->batch->view = ctx->view;
+   ctx->batch->committee = ctx->committee;
+   ctx->batch->features = ctx->features;
+   ctx->batch->ts = salf_now_ns();
+   ctx->batch->throttle = ctx->throttle;
+   if (ctx->snapshot != NULL) {
+      ctx->batch->params = ctx->snapshot->params;
+      ctx->batch->params_gen = ctx->params_gen;
+   }
+   if (ctx->pool == NULL) {
+      salf_strategy_set_batch(&ctx->set, ctx->batch);
+      salf_snapshot_trim(ctx, ctx->params_gen);
+      return salf_send(ctx, ctx->batch);
+   }
+   if (ctx->batch->cnt == 0 && !ctx->windowed) {
+      return salf_collect(ctx, 0);
+   }
+
+   salf_pool_submit(ctx->pool, ctx->batch);
+   while ((ctx->batch = salf_pool_get(ctx->pool)) == NULL) {
+      // all batches of the next worker are in flight, wait for the oldest one
+      err |= salf_retire(ctx, salf_pool_collect(ctx->pool, 1));
+   }
+   return err | salf_collect(ctx, 0);
+}
+
+/*!
+ * \brief Process current batch and wait until all records are sent.
+ * Windows of windowed strategies are closed, one batch is dispatched to
+ * every worker for that.
+ * \param[in] ctx Context.
+ * \return 0 on success, 1 on send error.
+ */
+static int salf_sync(salf_ctx_t *ctx)
+{
+   size_t i;
+   size_t cnt = ctx->windowed && ctx->pool != NULL ? ctx->pool->cnt : 1;
+
+   for (i = 0; i < cnt; i++) {
+      ctx->batch->flush = ctx->windowed;
+      if (salf_dispatch(ctx)) {
          return 1;
-      }else{
-         threshold *= step + 1;
-         return 0;
       }
-   } else {
-      return 0;
    }
+   if (ctx->pool != NULL) {
+      return salf_collect(ctx, 1);
+   }
+   return 0;
+}
+
+/*!
+ * \brief Reload input template after format change.
+ * Redefines UniRec fields according to the sender's format, creates new
+ * template, resolves record view and propagates the format to the output
+ * interface.
+ * \param[in,out] in_tmplt Input template, the old one is freed.
+ * \param[out] view View of records with resolved offsets.
+ * \param[out] committee Committee fields with resolved offsets.
+ * \param[out] features Feature fields with resolved offsets.
+ * \param[in] params Current parameters, one per output interface.
+ * \param[in] nout Number of output interfaces.
+ * \return 0 on success, 1 on error (template is freed and set to NULL).
+ */
+static int salf_update_template(ur_template_t **in_tmplt, salf_view_t *view, salf_committee_t *committee, salf_features_t *features, const salf_params_t *params, size_t nout)
+{
+   // Get the data format of senders output interface (the data format of the output interface it is connected to)
+   const char *spec = NULL;
+   const char *missing;
+   uint8_t data_fmt = TRAP_FMT_UNKNOWN;
+   size_t i;
+   if (trap_get_data_fmt(TRAPIFC_INPUT, 0, &data_fmt, &spec) != TRAP_E_OK) {
+      fprintf(stderr, "Data format was not loaded.");
+      return 1;
+   }
+
+   if (*in_tmplt != NULL) {
+      ur_free_template(*in_tmplt);
+      *in_tmplt = NULL;
+   }
+
+   if (ur_define_set_of_fields(spec) != UR_OK) {
+      if (verb) {
+         fprintf(stderr, "Error: Unirec fields could not be defined...\n");
+      }
+      return 1;
+   }
+   *in_tmplt = ur_create_template_from_ifc_spec(spec);
+   if (*in_tmplt == NULL) {
+      if (verb) {
+         fprintf(stderr, "Error: template...\n");
+      }
+      return 1;
+   }
+   missing = salf_view_resolve(view, *in_tmplt);
+   if (missing == NULL) {
+      missing = salf_committee_resolve(committee, *in_tmplt, committee_names, committee_cnt);
+   }
+   if (missing == NULL) {
+      missing = salf_features_resolve(features, *in_tmplt, features_names, features_cnt);
+   }
+   if (missing != NULL) {
+      if (verb) {
+         fprintf(stderr, "Error: field %s is not present in template or has wrong type...\n", missing);
+      }
+      ur_free_template(*in_tmplt);
+      *in_tmplt = NULL;
+      return 1;
+   }
+   for (i = 0; i < nout; i++) {
+      if (salf_params_check_view(&params[i], view)) {
+         ur_free_template(*in_tmplt);
+         *in_tmplt = NULL;
+         return 1;
+      }
+   }
+   // Set the same data format to repeaters output interfaces
+   for (i = 0; i < nout; i++) {
+      trap_set_data_fmt(i, TRAP_FMT_UNIREC, spec);
+   }
+   return 0;
 }
 
-void salf(int query_strategy)
+static uint64_t salf_elapsed_ns(const struct timespec *start)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (now.tv_sec * NS + now.tv_nsec) - (start->tv_sec * NS + start->tv_nsec);
+}
+
+static void salf_print_periodic_stats(const salf_ctx_t *ctx, const salf_stats_t *last, uint64_t interval_ns)
+{
+   const salf_stats_t *stats = &ctx->stats;
+   double secs = (double)interval_ns / NS;
+   uint64_t batches = stats->send_batches - last->send_batches;
+
+   fprintf(stderr, "Info: received %" PRIu64 ", sent %" PRIu64 ", timeouts %" PRIu64 ", %.0f flows/s, send %.1f us/batch",
+           stats->cnt_r, stats->cnt_s, stats->cnt_t,
+           secs > 0 ? (double)(stats->cnt_r - last->cnt_r) / secs : 0,
+           batches > 0 ? (double)(stats->send_ns - last->send_ns) / batches / 1000 : 0);
+   if (ctx->throttle_ns > 0) {
+      fprintf(stderr, ", throttle %.4f, congested %" PRIu64, ctx->throttle, stats->congested - last->congested);
+   }
+   fprintf(stderr, "\n");
+}
+
+void salf(const salf_params_t *params, size_t nout, uint64_t seed, size_t batch_size, size_t workers)
 {
    int ret;
    uint16_t data_size;
-   uint64_t cnt_r = 0; //Flows received
-   uint64_t cnt_s = 0; //Flows sent
-   uint64_t cnt_t = 0; //timeouts
+   salf_stats_t last_stats;
    uint64_t diff;
+   uint64_t last_report = 0;
+   uint64_t next_check = SALF_STATS_CHECK_RECS;
    const void *data;
-   struct timespec start, end;
+   struct timespec start;
    ur_template_t * in_tmplt= NULL;
-   int fieldID =0; //field ID of argmax P 
-   char (* strategy_fnc)(const void *, ur_template_t * ,int) = &random_strategy;
-
-   switch (query_strategy){
-   case 0:
-      strategy_fnc = &random_strategy;
-      break;
-   case 1:
-      strategy_fnc = &fixed_uncertainty_strategy;
-      break;
-   case 2:
-      strategy_fnc = &variable_uncertainty_strategy;
-      break;
-   case 3:
-      strategy_fnc = &uncertainty_strategy_with_randomization;
-      break;      
-   default:
-      break;
+   salf_ctx_t ctx;
+   salf_batch_t batch;
+   salf_pool_t pool;
+   salf_ckpt_t ckpt;
+   salf_ckpt_t *ckptp = NULL;
+   const char *kernel;
+   size_t i;
+
+   memset(&ctx, 0, sizeof(ctx));
+   memset(&last_stats, 0, sizeof(last_stats));
+   ctx.nout = nout;
+   ctx.base = params;
+   ctx.throttle = 1.0;
+   ctx.throttle_min = 1.0;
+   ctx.throttle_ns = backpressure_us * 1000;
+   ctx.windowed = salf_params_windowed(params, nout);
+   if (salf_strategy_set_init(&ctx.set, params, nout, seed, 0)) {
+      fprintf(stderr, "Error: Could not allocate strategies.\n");
+      return;
    }
 
    data_size = 0;
    data = NULL;
+   kernel = probas_init();
+   fvec_init();
+   rng_init();
+
+   if (state_file != NULL) {
+      if (salf_ckpt_open(&ckpt, state_file, workers > 0 ? workers : 1, nout)) {
+         salf_strategy_set_free(&ctx.set);
+         return;
+      }
+      ckptp = &ckpt;
+      if (ckpt.old != NULL) {
+         fprintf(stderr, "Info: Strategy state restored from %s.\n", state_file);
+      }
+      if (workers == 0) {
+         salf_ckpt_attach(&ckpt, &ctx.set, 0);
+      }
+   }
+
+   if (workers > 0) {
+      if (salf_pool_init(&pool, workers, batch_size, params, nout, seed, ckptp)) {
+         fprintf(stderr, "Error: Could not start %zu workers.\n", workers);
+         salf_strategy_set_free(&ctx.set);
+         if (ckptp != NULL) {
+            salf_ckpt_close(ckptp);
+         }
+         return;
+      }
+      ctx.pool = &pool;
+      ctx.batch = salf_pool_get(&pool);
+   } else {
+      if (salf_batch_init(&batch, batch_size, nout)) {
+         fprintf(stderr, "Error: Could not allocate batch of %zu records.\n", batch_size);
+         salf_strategy_set_free(&ctx.set);
+         if (ckptp != NULL) {
+            salf_ckpt_close(ckptp);
+         }
+         return;
+      }
+      ctx.batch = &batch;
+   }
+
    if (verb) {
-      fprintf(stderr, "Info: Initializing salf...\n");
+      fprintf(stderr, "Info: Initializing salf (%zu strategies, batch size %zu, %zu workers, %s kernels)...\n", nout, batch_size, workers, kernel);
    }
    clock_gettime(CLOCK_MONOTONIC, &start);
 
@@ -223,13 +664,29 @@ void salf(int query_strategy)
 
    trap_set_required_fmt(0, TRAP_FMT_UNIREC, "");
 
+   salf_timeouts_set(&ctx);
+
    TRAP_REGISTER_DEFAULT_SIGNAL_HANDLER();
+   if (params_file != NULL) {
+      struct sigaction sa;
+      memset(&sa, 0, sizeof(sa));
+      sa.sa_handler = salf_sighup_handler;
+      sa.sa_flags = SA_RESTART;
+      sigemptyset(&sa.sa_mask);
+      sigaction(SIGHUP, &sa, NULL);
+   }
 
    //main loop
    while (stop == 0) {
+      if (reload) {
+         reload = 0;
+         if (salf_reload(&ctx) == 0) {
+            fprintf(stderr, "Info: Strategy parameters reloaded from %s.\n", params_file);
+         }
+      }
       ret = trap_recv(0, &data, &data_size);
       if (ret == TRAP_E_OK || ret == TRAP_E_FORMAT_CHANGED) {
-         cnt_r++;
+         ctx.stats.cnt_r++;
          if (ret == TRAP_E_OK && in_tmplt != NULL) {
             if (data_size <= 1) {
                if (verb) {
@@ -238,81 +695,101 @@ void salf(int query_strategy)
                stop = 1;
             }
          } else {
-            // Get the data format of senders output interface (the data format of the output interface it is connected to)
-            const char *spec = NULL;
-            uint8_t data_fmt = TRAP_FMT_UNKNOWN;
-            if (trap_get_data_fmt(TRAPIFC_INPUT, 0, &data_fmt, &spec) != TRAP_E_OK) {
-               fprintf(stderr, "Data format was not loaded.");
-               return;
+            // records received in the old format have to be decided and sent before format changes
+            if (salf_sync(&ctx)) {
+               break;
             }
-
-            if(in_tmplt != NULL){
-               ur_free_template(in_tmplt);
+            if (salf_update_template(&in_tmplt, &ctx.view, &ctx.committee, &ctx.features, ctx.snapshot != NULL ? ctx.snapshot->params : params, nout)) {
+               break;
             }
-            
-            if(ur_define_set_of_fields(spec) != UR_OK){
-               if (verb) {
-                  fprintf(stderr, "Error: Unirec fields could not be defined...\n");
-               }
-               return;
+            ctx.resolved = 1;
+         }
+         
+         if (stop == 1) {
+            if (salf_sync(&ctx)) {
+               break;
             }
-            in_tmplt = ur_create_template_from_ifc_spec(spec);
-            fieldID = ur_get_id_by_name(PROP_FIELD_NAME);
-            if (fieldID < 0 || in_tmplt == NULL)
-            {
-               if (verb) {
-                  fprintf(stderr, "Error: template...\n");
-               }
-               return;
+            if (sendeof == 0) {
+               /* terminating module without eof message */
+               break;
             }
-            if (!ur_is_array(fieldID))
-            {
-               if (verb) {
-                  fprintf(stderr, "Error: template...\n");
-               }
-               ur_free_template(in_tmplt);
-               return;
+            for (i = 0; i < nout; i++) {
+               trap_send(i, data, data_size);
             }
-            if(!ur_is_present(in_tmplt,fieldID)){
-               if (verb) {
-                  fprintf(stderr, "Error: field is not present in template...\n");
-               }
-               ur_free_template(in_tmplt);
-               return;               
+            break;
+         }
+
+         if (salf_batch_push(ctx.batch, data, data_size)) {
+            if (salf_dispatch(&ctx)) {
+               break;
             }
-            // Set the same data format to repeaters output interface
-            trap_set_data_fmt(0, TRAP_FMT_UNIREC, spec);
+            salf_batch_push(ctx.batch, data, data_size);
          }
-         
-         if (stop == 1 && sendeof == 0){
-            /* terminating module without eof message */
+         if (ctx.batch->cnt < ctx.batch->cap) {
+            continue;
+         }
+         if (salf_dispatch(&ctx)) {
             break;
-         } else {
-            
-            if(!(*strategy_fnc)(data,in_tmplt,fieldID)){
-               continue;
-            }
-
-            ret = trap_send(0, data, data_size);
-            if (ret == TRAP_E_OK) {
-               cnt_s++;
-               continue;
+         }
+         if (verb && ctx.stats.cnt_r >= next_check) {
+            next_check = ctx.stats.cnt_r + SALF_STATS_CHECK_RECS;
+            diff = salf_elapsed_ns(&start);
+            if (diff - last_report >= SALF_STATS_INTERVAL * (uint64_t)NS) {
+               salf_print_periodic_stats(&ctx, &last_stats, diff - last_report);
+               last_stats = ctx.stats;
+               last_report = diff;
             }
-            TRAP_DEFAULT_SEND_DATA_ERROR_HANDLING(ret, cnt_t++; continue, break)
+         }
+      } else if (ret == TRAP_E_TIMEOUT && (batch_size > 1 || workers > 0 || ctx.windowed)) {
+         if (salf_dispatch(&ctx)) {
+            break;
          }
       } else {
-         TRAP_DEFAULT_GET_DATA_ERROR_HANDLING(ret, cnt_t++; puts("trap_recv timeout"); continue, break)
+         TRAP_DEFAULT_GET_DATA_ERROR_HANDLING(ret, ctx.stats.cnt_t++; puts("trap_recv timeout"); continue, break)
       }
    }
 
-   clock_gettime(CLOCK_MONOTONIC, &end);
-   diff = (end.tv_sec * NS + end.tv_nsec) - (start.tv_sec * NS + start.tv_nsec);
-   fprintf(stderr, "Info: Flows received:  %16" PRIu64 "\n", cnt_r > 0 ? cnt_r - 1 : cnt_r);
-   fprintf(stderr, "Info: Flows sent:      %16" PRIu64 "\n", cnt_s > 0 ? cnt_s - 1 : cnt_s);
-   fprintf(stderr, "Info: %% of Flows sent:%16.2f%%"  "\n", cnt_r > 0 ?  ((double)cnt_s/ (double)cnt_r)*100: 0);
-   fprintf(stderr, "Info: Timeouts:        %16" PRIu64 "\n", cnt_t);
+   // do not drop records buffered before the signal arrived
+   if (in_tmplt != NULL) {
+      salf_sync(&ctx);
+   }
+
+   diff = salf_elapsed_ns(&start);
+   fprintf(stderr, "Info: Flows received:  %16" PRIu64 "\n", ctx.stats.cnt_r > 0 ? ctx.stats.cnt_r - 1 : ctx.stats.cnt_r);
+   fprintf(stderr, "Info: Flows sent:      %16" PRIu64 "\n", ctx.stats.cnt_s);
+   for (i = 0; nout > 1 && i < nout; i++) {
+      fprintf(stderr, "Info: Sent to IFC %-4zu %16" PRIu64 " (%.2f%%)\n", i, ctx.stats.sent[i],
+              ctx.stats.cnt_r > 0 ? ((double)ctx.stats.sent[i] / (double)ctx.stats.cnt_r) * 100 : 0);
+   }
+   fprintf(stderr, "Info: %% of Flows sent:%16.2f%%"  "\n", ctx.stats.cnt_r > 0 ?  ((double)ctx.stats.cnt_s/ (double)ctx.stats.cnt_r)*100: 0);
+   fprintf(stderr, "Info: Timeouts:        %16" PRIu64 "\n", ctx.stats.cnt_t);
+   fprintf(stderr, "Info: Send timeouts:   %16" PRIu64 "\n", ctx.stats.send_t);
+   fprintf(stderr, "Info: Send us/batch:   %16.1f\n", ctx.stats.send_batches > 0 ? (double)ctx.stats.send_ns / ctx.stats.send_batches / 1000 : 0);
+   if (ctx.throttle_ns > 0) {
+      fprintf(stderr, "Info: Congested sends: %16" PRIu64 "\n", ctx.stats.congested);
+      fprintf(stderr, "Info: Throttle level:  %16.4f (min %.4f)\n", ctx.throttle, ctx.throttle_min);
+   }
    fprintf(stderr, "Info: Time elapsed:    %12" PRIu64 ".%03" PRIu64 "s\n", diff / NS, (diff % NS) / 1000000);
+   fprintf(stderr, "Info: Flows/s:         %16.0f\n", diff > 0 ? (double)ctx.stats.cnt_r / ((double)diff / NS) : 0);
 
+   if (ctx.pool != NULL) {
+      salf_pool_stop(&pool);
+      if (verb) {
+         salf_pool_print_stats(&pool);
+      }
+      salf_pool_free(&pool);
+   } else {
+      salf_batch_free(&batch);
+   }
+   salf_strategy_set_free(&ctx.set);
+   if (ckptp != NULL) {
+      salf_ckpt_close(ckptp);
+   }
+   while (ctx.snapshot != NULL) {
+      salf_params_snapshot_t *older = ctx.snapshot->next;
+      free(ctx.snapshot);
+      ctx.snapshot = older;
+   }
    if(in_tmplt != NULL){
       ur_free_template(in_tmplt);
    }
@@ -320,41 +797,246 @@ void salf(int query_strategy)
 }
 
 
+/*!
+ * \brief Count strategy configurations given by -c/--config.
+ * Number of output interfaces has to be known before libtrap is initialized.
+ * Only separate -c/--config arguments are counted, main() rejects other forms
+ * when they change the number of output interfaces.
+ * \param[in] argc Number of given parameters.
+ * \param[in] argv Array of given parameters.
+ * \return Number of configurations.
+ */
+static int salf_count_configs(int argc, char **argv)
+{
+   int i;
+   int cnt = 0;
+
+   for (i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--config") == 0) {
+         cnt++;
+         i++;
+      } else if (strncmp(argv[i], "--config=", 9) == 0 || (strncmp(argv[i], "-c", 2) == 0 && argv[i][2] != '\0' && argv[i][2] != '-')) {
+         cnt++;
+      }
+   }
+   return cnt;
+}
+
 int main(int argc, char **argv)
 {
+   int nconfigs = salf_count_configs(argc, argv);
+   const char *configs[SALF_OUTPUTS_MAX];
+   salf_params_t config_params[SALF_OUTPUTS_MAX];
+   int nout = 0;
+   int i;
+
    INIT_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+   if (nconfigs > SALF_OUTPUTS_MAX) {
+      fprintf(stderr, "Error: At most %d strategy configurations are supported.\n", SALF_OUTPUTS_MAX);
+      FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+      return EXIT_FAILURE;
+   }
+   if (nconfigs > 1) {
+      // one output interface per strategy configuration
+      module_info->num_ifc_out = nconfigs;
+   }
    TRAP_DEFAULT_INITIALIZATION(argc, argv, *module_info);
    verb = (trap_get_verbose_level() >= 0);
    signed char opt;
-   int query_strategy = 0;
+   char *name;
+   salf_params_t params = SALF_PARAMS_DEFAULT;
+   uint64_t seed;
+   long batch_size = SALF_BATCH_DEFAULT;
+   long workers = 0;
    
-   srand(time(NULL)); // randomize seed
+   seed = (uint64_t)time(NULL); // randomize seed
    
    while ((opt = TRAP_GETOPT(argc, argv, module_getopt_string, long_options)) != -1) {
       switch (opt) {
       case 'n':
          sendeof = 0;
          break;
+      case 'P'://backpressure
+         backpressure_us = strtoull(optarg, NULL, 10);
+         break;
+      case 'k'://state file
+         state_file = optarg;
+         break;
+      case 'f'://file with strategy configurations
+         params_file = optarg;
+         break;
+      case 'c'://strategy configuration
+         if (nout == SALF_OUTPUTS_MAX) {
+            fprintf(stderr, "Error: At most %d strategy configurations are supported.\n", SALF_OUTPUTS_MAX);
+            TRAP_DEFAULT_FINALIZATION();
+            FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+            return EXIT_FAILURE;
+         }
+         configs[nout++] = optarg;
+         break;
       case 'b'://budget
-         budget = strtod(optarg, NULL);
+         params.budget = strtod(optarg, NULL);
          
          break;
       case 'q'://query strategy
-         query_strategy = atoi(optarg);
+         params.query_strategy = atoi(optarg);
+         break;
+      case 'g'://proportional gain
+         params.kp = strtod(optarg, NULL);
+         break;
+      case 'G'://integral gain
+         params.ki = strtod(optarg, NULL);
+         break;
+      case 'W'://budget window
+         params.window = (unsigned int)atoi(optarg);
+         break;
+      case 'e'://committee measure
+         params.committee_measure = atoi(optarg);
+         break;
+      case 'y'://stratified budget
+         params.stratify = atoi(optarg);
+         break;
+      case 'x'://flow key
+         params.hash_key = (unsigned int)strtoul(optarg, NULL, 0);
+         break;
+      case 'o'://one-way flow key
+         params.hash_oneway = 1;
+         break;
+      case 'u'://labels per endpoint pair
+         params.dedup = (unsigned int)atoi(optarg);
+         break;
+      case 'l'://half-life of labels per endpoint pair
+         params.dedup_halflife = strtod(optarg, NULL);
+         break;
+      case 'H'://label share of source host
+         params.host_share = strtod(optarg, NULL);
+         break;
+      case 'J'://labels per host window
+         params.host_window = (unsigned int)atoi(optarg);
+         break;
+      case 'K'://records per window
+         params.select_k = (unsigned int)atoi(optarg);
+         break;
+      case 'N'://window
+         params.select_window = (unsigned int)atoi(optarg);
+         break;
+      case 'I'://window duration
+         params.select_interval = strtod(optarg, NULL);
+         break;
+      case 'm'://committee fields
+         committee_cnt = 0;
+         for (name = strtok(optarg, ","); name != NULL; name = strtok(NULL, ",")) {
+            if (committee_cnt == SALF_COMMITTEE_MAX) {
+               fprintf(stderr, "Error: Committee has at most %d members.\n", SALF_COMMITTEE_MAX);
+               TRAP_DEFAULT_FINALIZATION();
+               FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+               return EXIT_FAILURE;
+            }
+            committee_names[committee_cnt++] = name;
+         }
+         break;
+      case 'F'://feature fields
+         features_cnt = 0;
+         for (name = strtok(optarg, ","); name != NULL; name = strtok(NULL, ",")) {
+            if (features_cnt == SALF_FEATURES_MAX) {
+               fprintf(stderr, "Error: At most %d feature fields.\n", SALF_FEATURES_MAX);
+               TRAP_DEFAULT_FINALIZATION();
+               FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+               return EXIT_FAILURE;
+            }
+            features_names[features_cnt++] = name;
+         }
+         break;
+      case 'C'://clusters of diversity strategy
+         params.clusters = (unsigned int)atoi(optarg);
+         break;
+      case 'L'://bands of feature signature
+         params.lsh_bands = (unsigned int)atoi(optarg);
+         break;
+      case 'T'://TTL of feature signatures
+         params.lsh_ttl = strtod(optarg, NULL);
+         break;
+      case 'a'://auto threshold
+         params.auto_threshold = 1;
          break;
       case 't'://treshold
-         labeling_threshold = strtod(optarg, NULL);
+         params.labeling_threshold = strtod(optarg, NULL);
          break;
       case 's'://step
-         step = strtod(optarg, NULL);
+         params.step = strtod(optarg, NULL);
          break;
       case 'd'://deviation
-         t_deviation = strtod(optarg, NULL);
+         params.t_deviation = strtod(optarg, NULL);
+         break;
+      case 'r'://rate budget
+         params.rate = strtod(optarg, NULL);
+         break;
+      case 'R'://burst of rate budget
+         params.burst = strtod(optarg, NULL);
+         break;
+      case 'S'://seed
+         seed = strtoull(optarg, NULL, 10);
          break;
+      case 'w'://workers
+         workers = strtol(optarg, NULL, 10);
+         if (workers < 0 || workers > SALF_WORKERS_MAX) {
+            fprintf(stderr, "Error: Number of workers must be in interval [0,%d].\n", SALF_WORKERS_MAX);
+            TRAP_DEFAULT_FINALIZATION();
+            FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+            return EXIT_FAILURE;
+         }
+         break;
+      case 'B'://batch
+         batch_size = strtol(optarg, NULL, 10);
+         if (batch_size < 1 || batch_size > SALF_BATCH_MAX) {
+            fprintf(stderr, "Error: Batch size must be in interval [1,%d].\n", SALF_BATCH_MAX);
+            TRAP_DEFAULT_FINALIZATION();
+            FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+            return EXIT_FAILURE;
+         }
+         break;
+      }
+   }
+
+   if (nout != nconfigs && (nout > 1 || nconfigs > 1)) {
+      // output interfaces were created from the pre-scan of arguments
+      fprintf(stderr, "Error: Found %d strategy configurations, %d expected, give each as a separate -c <config> or --config=<config>.\n", nout, nconfigs);
+      TRAP_DEFAULT_FINALIZATION();
+      FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+      return EXIT_FAILURE;
+   }
+
+   // configurations override parameters given by -q, -b, -t, -s, -d
+   for (i = 0; i < nout; i++) {
+      config_params[i] = params;
+      if (salf_params_parse(&config_params[i], configs[i])) {
+         fprintf(stderr, "Error: Invalid strategy configuration '%s'.\n", configs[i]);
+         TRAP_DEFAULT_FINALIZATION();
+         FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+         return EXIT_FAILURE;
+      }
+   }
+   if (nout == 0) {
+      config_params[nout++] = params;
+   }
+   if (params_file != NULL) {
+      size_t cnt;
+      if (salf_params_load(params_file, config_params, SALF_OUTPUTS_MAX, &cnt) || cnt != (size_t)nout) {
+         fprintf(stderr, "Error: %s has to contain %d strategy configurations (one per output interface).\n", params_file, nout);
+         TRAP_DEFAULT_FINALIZATION();
+         FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+         return EXIT_FAILURE;
+      }
+   }
+   for (i = 0; i < nout; i++) {
+      if (salf_params_validate(&config_params[i], committee_cnt, features_cnt)) {
+         TRAP_DEFAULT_FINALIZATION();
+         FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
+         return EXIT_FAILURE;
       }
    }
 
-   salf(query_strategy);
+   salf(config_params, (size_t)nout, seed, (size_t)batch_size, (size_t)workers);
 
    TRAP_DEFAULT_FINALIZATION();
    FREE_MODULE_INFO_STRUCT(MODULE_BASIC_INFO, MODULE_PARAMS)
@@ -61,6 +61,7 @@
 #include <inttypes.h>
 #include <libtrap/trap.h>
 #include <unirec/unirec.h>
+#include <ur_view.h>
 
 /*!
  * \name Default values
@@ -71,63 +72,200 @@
 
 #define NS 1000000000 /*< Number of nanoseconds in a second. */
 
-#define T_MAX 100000 /*< Max value of t. */
+#define SALF_QUANTILE_WINDOW 100000 /*< Forget window of streaming quantile estimation. */
 
-#define PROP_FIELD_NAME "PREDICTED_PROBAS" /*Name of Probability array. */
+
+#define SALF_BATCH_DEFAULT 1 /*< Default number of records in one batch. */
+#define SALF_BATCH_MAX 65536 /*< Max number of records in one batch. */
+#define SALF_BATCH_ARENA_REC 512 /*< Arena bytes reserved per batched record. */
+#define SALF_BATCH_ARENA_MIN 131072 /*< Min arena size, fits at least one max size record. */
+#define SALF_BATCH_TIMEOUT 100000 /*< Input timeout (us) after which incomplete batch is processed. */
+
+#define SALF_OUTPUTS_MAX 32 /*< Max number of output interfaces (strategy configurations). */
+
+#define SALF_WORKERS_MAX 64 /*< Max number of worker threads. */
+#define SALF_WORKER_BATCHES 8 /*< Number of batches owned by every worker, power of 2. */
+
+#define SALF_STATS_INTERVAL 10 /*< Seconds between periodic statistics (verbose mode). */
+#define SALF_COMMITTEE_MAX 16 /*< Max number of committee members. */
+#define SALF_COMMITTEE_CLASSES 8192 /*< Max number of classes used by committee (doubles in max size record). */
+#define SALF_WINDOW_MAX 65536 /*< Max number of flows in budget window (8 KiB per strategy instance). */
+#define SALF_WINDOW_DEFAULT 32768 /*< Default number of flows in budget window. */
+#define SALF_PI_WINDOW 1000 /*< Number of flows the label rate of PI controller is averaged over. */
+#define SALF_PI_KP 0.5 /*< Default proportional gain of PI controller. */
+#define SALF_PI_KI 0.001 /*< Default integral gain of PI controller. */
+#define SALF_PI_OVERSHOOT 1.1 /*< Max ratio of label rate and budget of PI controller. */
+#define SALF_QUANTILE_MIN 1e-6 /*< Min (and 1 - max) budget quantile tracked by auto threshold. */
+#define SALF_THROTTLE_MIN (1.0 / 1024) /*< Min fraction of flows offered to strategies under backpressure. */
+#define SALF_THROTTLE_STEP (1.0 / 64) /*< Recovery of throttle level per batch sent without congestion. */
+#define SALF_STRATA_MAX 256 /*< Max number of classes with own quota, higher class ids share the last one. */
+#define SALF_STRATA_HORIZON (1 << 20) /*< Number of flows after which class counters are halved. */
+#define SALF_SELECT_MAX 65536 /*< Max number of records held by windowed strategy. */
+#define SALF_SELECT_WINDOW_DEFAULT 10000 /*< Default number of records in window of windowed strategies. */
+#define SALF_SELECT_INTERVAL_DEFAULT 1.0 /*< Default max duration of window of windowed strategies in seconds. */
+#define SALF_SKETCH_DEPTH 4 /*< Number of rows of count-min sketch of endpoint pairs. */
+#define SALF_SKETCH_WIDTH 16384 /*< Number of counters in row of sketch (power of 2), 128 KiB per strategy instance. */
+#define SALF_DEDUP_HALFLIFE_DEFAULT 60.0 /*< Default half-life of label counts of endpoint pairs in seconds. */
+#define SALF_HOSTS_MAX 256 /*< Number of source hosts monitored by Space-Saving (per strategy instance). */
+#define SALF_HOSTS_WINDOW_DEFAULT 1000 /*< Default number of labels in window of per-host cap. */
+#define SALF_FEATURES_MAX 16 /*< Max number of feature fields. */
+#define SALF_LSH_SLOTS 16384 /*< Number of slots of LSH bucket table shared by bands (power of 2), 128 KiB per strategy instance. */
+#define SALF_SCALER_HORIZON 4096 /*< Number of flows feature mean and variance are averaged over (standardization of features). */
+#define SALF_SCALER_WARMUP 256 /*< Number of flows standardization is rescaled per flow for, signatures of these flows are not used. */
+#define SALF_LSH_TTL_DEFAULT 1.0 /*< Default time signatures of labeled flows stay in LSH table in seconds. */
+#define SALF_CLUSTERS_MAX 64 /*< Max number of clusters of diversity strategy (multiple of 16). */
+#define SALF_CLUSTERS_DEFAULT 16 /*< Default number of clusters of diversity strategy. */
+#define SALF_CLUSTER_COUNT_MAX 1024 /*< Cap of update count of centroid, min learning rate is its inverse. */
+#define SALF_CLUSTER_HORIZON (1 << 16) /*< Number of flows after which flow and label counts of clusters are halved. */
+#define SALF_CLUSTER_WARMUP 1024 /*< Number of flows standardization is trained on before clustering starts. */
+#define SALF_STATS_CHECK_RECS 65536 /*< Number of records between checks of the statistics timer. */
 
 /*! \} */
 
 
 
 /*!
- * \brief Random Strategy function (ID 0)
- * Function to ...
- * \param[in] data Pointer to data.
- * \param[in] in_tmplt UniRec template.
- * \param[in] fieldID ID of field with propability.
- * \return {true,false} indicates whether to request the true label.
+ * \brief Fields read by strategies.
+ * PREDICTED_PROBAS is the array of class probabilities. Flow key fields are
+ * optional, they are read only by strategies keyed on flows.
  */
-char random_strategy(const void *data,ur_template_t * in_tmplt,int fieldID);
+#define SALF_VIEW_FIELDS(F, V) \
+   F(V, ARRAY, double, UR_TYPE_A_DOUBLE, PREDICTED_PROBAS, UR_VIEW_REQUIRED) \
+   F(V, SCALAR, ip_addr_t, UR_TYPE_IP, SRC_IP, UR_VIEW_OPTIONAL) \
+   F(V, SCALAR, ip_addr_t, UR_TYPE_IP, DST_IP, UR_VIEW_OPTIONAL) \
+   F(V, SCALAR, uint16_t, UR_TYPE_UINT16, SRC_PORT, UR_VIEW_OPTIONAL) \
+   F(V, SCALAR, uint16_t, UR_TYPE_UINT16, DST_PORT, UR_VIEW_OPTIONAL) \
+   F(V, SCALAR, uint8_t, UR_TYPE_UINT8, PROTOCOL, UR_VIEW_OPTIONAL)
 
+UR_VIEW_DEFINE(salf_view, SALF_VIEW_FIELDS)
 
 /*!
- * \brief  Fixed Uncertainty Strategy (ID 1)
- * Function to ...
- * \param[in] data Pointer to data.
- * \param[in] in_tmplt UniRec template.
- * \param[in] fieldID ID of field with propability.
- * \return {true,false} indicates whether to request the true label.
+ * \brief Probability arrays of committee members.
+ * Fields are given by name on command line, offsets are resolved with the
+ * view after every format change.
  */
-char fixed_uncertainty_strategy(const void *data,ur_template_t * in_tmplt,int fieldID);
+typedef struct salf_committee_s {
+   uint16_t static_size; /*< Size of static part of records. */
+   size_t cnt; /*< Number of members. */
+   int16_t offset[SALF_COMMITTEE_MAX]; /*< Offsets of probability arrays of members. */
+} salf_committee_t;
 
 /*!
- * \brief Variable Uncertainty Strategy (ID 2)
- * Function to ...
- * \param[in] data Pointer to data.
- * \param[in] in_tmplt UniRec template.
- * \param[in] fieldID ID of field with propability.
- * \return {true,false} indicates whether to request the true label.
+ * \brief Numeric feature fields.
+ * Fields are given by name on command line and may have any integer or
+ * floating point type, offsets and types are resolved after every format change.
+ */
+typedef struct salf_features_s {
+   size_t cnt; /*< Number of fields. */
+   int16_t offset[SALF_FEATURES_MAX]; /*< Offsets of fields. */
+   int type[SALF_FEATURES_MAX]; /*< UniRec types of fields. */
+} salf_features_t;
+
+/*!
+ * \brief Records released by windowed strategies.
+ * Windowed strategies hold copies of records until their window closes,
+ * released records are copied here and sent after records of the batch.
+ */
+typedef struct salf_release_s {
+   char *arena; /*< Storage of record copies. */
+   size_t arena_size; /*< Size of arena in bytes. */
+   size_t arena_used; /*< Used bytes of arena. */
+   size_t *off; /*< Offsets of records in arena. */
+   uint16_t *size; /*< Sizes of records. */
+   uint16_t *out; /*< Output interfaces of records. */
+   size_t cnt; /*< Number of records. */
+   size_t cap; /*< Allocated number of records. */
+} salf_release_t;
+
+/*!
+ * \brief Counters of the main loop.
+ */
+typedef struct salf_stats_s {
+   uint64_t cnt_r; /*< Flows received. */
+   uint64_t cnt_s; /*< Flows sent (all output interfaces). */
+   uint64_t cnt_t; /*< Timeouts. */
+   uint64_t send_t; /*< Timeouts of output interfaces (included in cnt_t). */
+   uint64_t send_ns; /*< Time spent by sending batches. */
+   uint64_t send_batches; /*< Batches with at least one sent flow. */
+   uint64_t congested; /*< Batches sent under congestion (backpressure). */
+   uint64_t sent[SALF_OUTPUTS_MAX]; /*< Flows sent per output interface. */
+} salf_stats_t;
+
+struct salf_params_s;
+
+/*!
+ * \brief Batch of received records.
+ * Records are copied into a reusable arena because data returned by
+ * trap_recv() are valid only until the next call.
+ */
+typedef struct salf_batch_s {
+   char *arena; /*< Storage of record copies. */
+   size_t arena_size; /*< Size of arena in bytes. */
+   size_t arena_used; /*< Used bytes of arena. */
+   const void **rec; /*< Pointers to records in arena. */
+   uint16_t *size; /*< Sizes of records. */
+   char *decision; /*< Strategy decisions, cap per output interface. */
+   double *maxp; /*< Max probabilities shared by strategies, negative if not computed. */
+   size_t nout; /*< Number of output interfaces. */
+   salf_view_t view; /*< Offsets of fields in records of batch. */
+   salf_committee_t committee; /*< Offsets of committee fields in records of batch. */
+   salf_features_t features; /*< Offsets of feature fields in records of batch. */
+   const struct salf_params_s *params; /*< Latest reloaded strategy parameters, NULL if none. */
+   unsigned int params_gen; /*< Generation of params. */
+   uint64_t ts; /*< Time of batch in ns (monotonic), refills rate budgets. */
+   double throttle; /*< Fraction of flows offered to strategies, 1 without backpressure. */
+   salf_release_t release; /*< Records released by windowed strategies. */
+   int flush; /*< Windows of windowed strategies are closed after the batch (format change, end of stream). */
+   size_t cnt; /*< Number of records in batch. */
+   size_t cap; /*< Max number of records in batch. */
+} salf_batch_t;
+
+/*!
+ * \brief Allocate batch.
+ * \param[out] batch Batch to initialize.
+ * \param[in] capacity Max number of records in batch.
+ * \param[in] nout Number of output interfaces.
+ * \return 0 on success, 1 on allocation failure.
  */
-char variable_uncertainty_strategy(const void *data,ur_template_t * in_tmplt,int fieldID);
+int salf_batch_init(salf_batch_t *batch, size_t capacity, size_t nout);
 
+/*!
+ * \brief Free memory of batch.
+ * \param[in] batch Batch to free.
+ */
+void salf_batch_free(salf_batch_t *batch);
 
 /*!
- * \brief Uncertainty Strategy with Randomization (ID 3)
- * Function to ...
+ * \brief Copy record into batch.
+ * \param[in] batch Batch.
  * \param[in] data Pointer to data.
- * \param[in] in_tmplt UniRec template.
- * \param[in] fieldID ID of field with propability.
- * \return {true,false} indicates whether to request the true label.
+ * \param[in] data_size Size of data.
+ * \return 0 on success, 1 if batch is full.
  */
-char uncertainty_strategy_with_randomization(const void *data,ur_template_t * in_tmplt,int fieldID);
+int salf_batch_push(salf_batch_t *batch, const void *data, uint16_t data_size);
 
+/*!
+ * \brief Send selected records of batch.
+ * Records selected by strategy k are sent to output interface k, records
+ * released by windowed strategies follow.
+ * Duration of the send and output timeouts are added to stats.
+ * Batch is empty afterwards.
+ * \param[in] batch Batch.
+ * \param[in,out] stats Counters of sent flows and timeouts.
+ * \return 0 on success, 1 on send error.
+ */
+int salf_batch_send(salf_batch_t *batch, salf_stats_t *stats);
 
 /*!
  * \brief SALF function
  * Function to resend received data from input interface to output interface.
- * \param[in] query_strategy ID of strategy to use.
+ * \param[in] params Parameters of strategies, one per output interface.
+ * \param[in] nout Number of output interfaces.
+ * \param[in] seed Seed of random number generator.
+ * \param[in] batch_size Number of records processed in one batch.
+ * \param[in] workers Number of worker threads, 0 to run strategy in the receiving thread.
  */
-void salf(int query_strategy);
+void salf(const struct salf_params_s *params, size_t nout, uint64_t seed, size_t batch_size, size_t workers);
 
 /*!
  * \brief Main function.
@@ -0,0 +1,590 @@
+/*!
+ * \file salf_replay.c
+ * \brief Offline evaluation of SALF strategies over trapcap files
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+#include "salf.h"
+#include "strategy.h"
+#include "fvec.h"
+
+/*
+ * Trapcap file written by libtrap FILE interface:
+ *
+ *    uint8_t  data format type (TRAP_FMT_UNIREC)
+ *    uint32_t length of format specification (network order, including '\0')
+ *    char     format specification
+ *    buffers: uint32_t buffer length (network order), then messages
+ *             uint16_t message length (network order), message data
+ *
+ * Files are mapped to memory, records are read in place.
+ */
+
+#define REPLAY_CONFIGS_MAX 4096 /*< Max number of evaluated configurations. */
+#define REPLAY_BATCH 1024 /*< Number of records decided in one call. */
+#define REPLAY_TRAJECTORY_STEP 10000 /*< Default number of records between threshold samples. */
+#define REPLAY_FLOW_RATE 100000 /*< Default simulated input rate in flows/s (drives rate budgets). */
+
+/*!
+ * \brief Records of one file.
+ */
+typedef struct replay_file_s {
+   const char *name; /*< File name. */
+   void *map; /*< Mapped file. */
+   size_t map_size; /*< Size of mapping. */
+   ur_template_t *tmplt; /*< Template of records. */
+   salf_view_t view; /*< Offsets of fields. */
+   salf_committee_t committee; /*< Offsets of committee fields. */
+   salf_features_t features; /*< Offsets of feature fields. */
+   const void **rec; /*< Records (pointers into mapping). */
+   uint16_t *size; /*< Sizes of records. */
+   size_t cnt; /*< Number of records. */
+} replay_file_t;
+
+/*!
+ * \brief Sample of threshold trajectory.
+ */
+typedef struct replay_sample_s {
+   uint64_t record; /*< Number of records seen. */
+   uint64_t labeled; /*< Number of records labeled so far. */
+   double threshold; /*< Threshold of strategy. */
+} replay_sample_t;
+
+/*!
+ * \brief Result of one configuration.
+ */
+typedef struct replay_result_s {
+   const char *spec; /*< Configuration. */
+   salf_params_t params; /*< Parsed configuration. */
+   uint64_t records; /*< Records decided. */
+   uint64_t labeled; /*< Records selected. */
+   double threshold_min; /*< Min threshold. */
+   double threshold_max; /*< Max threshold. */
+   double threshold_last; /*< Final threshold. */
+   uint64_t cpu_ns; /*< CPU time spent in strategy. */
+   replay_sample_t *trajectory; /*< Threshold samples. */
+   size_t trajectory_cnt; /*< Number of samples. */
+} replay_result_t;
+
+/*!
+ * \brief Shared state of evaluation threads.
+ */
+typedef struct replay_job_s {
+   replay_file_t *file; /*< Input files. */
+   size_t file_cnt; /*< Number of files. */
+   replay_result_t *result; /*< Results, one per configuration. */
+   size_t result_cnt; /*< Number of configurations. */
+   atomic_size_t next; /*< Next configuration to evaluate. */
+   uint64_t total; /*< Number of records in all files. */
+   uint64_t step; /*< Records between trajectory samples. */
+   uint64_t seed; /*< Seed of random number generators. */
+   double flow_rate; /*< Simulated input rate in flows/s. */
+} replay_job_t;
+
+static const char *committee_names[SALF_COMMITTEE_MAX]; /*< Names of probability arrays of committee members. */
+static size_t committee_cnt = 0; /*< Number of committee members. */
+static const char *features_names[SALF_FEATURES_MAX]; /*< Names of numeric feature fields. */
+static size_t features_cnt = 0; /*< Number of feature fields. */
+
+static void usage(const char *prog)
+{
+   fprintf(stderr,
+      "Usage: %s [-c config]... [-C file] [-j threads] [-T step] [-o trajectory.csv] [-S seed] [-F flows/s] [-m fields] [-X fields] file.trapcap...\n"
+      "  -c config   Strategy configuration, e.g. 'q=2,b=0.05,s=0.2' (keys q, b, t, s, d, r, R, a, g, G, W, e, y, k, n, i, x, o, u, l, h, j, L, T, C as in salf -c).\n"
+      "  -C file     File with one configuration per line.\n"
+      "  -j threads  Number of evaluation threads (default number of CPUs).\n"
+      "  -T step     Number of records between samples of threshold trajectory (default %d).\n"
+      "  -o file     Write threshold trajectory of all configurations as CSV.\n"
+      "  -S seed     Seed of random number generators (default 0).\n"
+      "  -F flows/s  Simulated input rate, time of records for rate budgets (default %d).\n"
+      "  -m fields   Comma separated probability arrays of committee members (strategy 7).\n"
+      "  -X fields   Comma separated numeric feature fields (near-duplicate suppression, strategy 11).\n"
+      "Files are replayed in the given order as one stream.\n",
+      prog, REPLAY_TRAJECTORY_STEP, REPLAY_FLOW_RATE);
+}
+
+/*!
+ * \brief Map trapcap file and index its records.
+ * \param[out] f File.
+ * \param[in] name File name.
+ * \return 0 on success, 1 on error.
+ */
+static int replay_file_open(replay_file_t *f, const char *name)
+{
+   struct stat st;
+   const unsigned char *p, *end;
+   uint32_t len;
+   size_t cap = 0;
+   const char *spec;
+   const char *missing;
+   int fd;
+
+   memset(f, 0, sizeof(*f));
+   f->name = name;
+   fd = open(name, O_RDONLY);
+   if (fd < 0 || fstat(fd, &st) != 0) {
+      fprintf(stderr, "Error: %s: %s\n", name, strerror(errno));
+      if (fd >= 0) {
+         close(fd);
+      }
+      return 1;
+   }
+   f->map_size = st.st_size;
+   f->map = f->map_size > 0 ? mmap(NULL, f->map_size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+   close(fd);
+   if (f->map == MAP_FAILED) {
+      fprintf(stderr, "Error: %s: could not map file.\n", name);
+      f->map = NULL;
+      return 1;
+   }
+   madvise(f->map, f->map_size, MADV_SEQUENTIAL);
+
+   p = f->map;
+   end = p + f->map_size;
+   if (end - p < 5 || p[0] != TRAP_FMT_UNIREC) {
+      fprintf(stderr, "Error: %s: not a UniRec trapcap file.\n", name);
+      return 1;
+   }
+   memcpy(&len, p + 1, sizeof(len));
+   len = ntohl(len);
+   p += 5;
+   if ((size_t)(end - p) < len || len == 0 || p[len - 1] != '\0') {
+      fprintf(stderr, "Error: %s: invalid format specification.\n", name);
+      return 1;
+   }
+   spec = (const char *)p;
+   p += len;
+
+   if (ur_define_set_of_fields(spec) != UR_OK || (f->tmplt = ur_create_template_from_ifc_spec(spec)) == NULL) {
+      fprintf(stderr, "Error: %s: could not create template from '%s'.\n", name, spec);
+      return 1;
+   }
+   missing = salf_view_resolve(&f->view, f->tmplt);
+   if (missing == NULL) {
+      missing = salf_committee_resolve(&f->committee, f->tmplt, committee_names, committee_cnt);
+   }
+   if (missing == NULL) {
+      missing = salf_features_resolve(&f->features, f->tmplt, features_names, features_cnt);
+   }
+   if (missing != NULL) {
+      fprintf(stderr, "Error: %s: field %s is not present or has wrong type.\n", name, missing);
+      return 1;
+   }
+
+   while (end - p >= 4) {
+      const unsigned char *buf_end;
+      memcpy(&len, p, sizeof(len));
+      len = ntohl(len);
+      p += 4;
+      if ((size_t)(end - p) < len) {
+         fprintf(stderr, "Warning: %s: truncated buffer, the rest of file is ignored.\n", name);
+         break;
+      }
+      buf_end = p + len;
+      while (buf_end - p >= 2) {
+         uint16_t size;
+         memcpy(&size, p, sizeof(size));
+         size = ntohs(size);
+         p += 2;
+         if (buf_end - p < size) {
+            fprintf(stderr, "Warning: %s: truncated message.\n", name);
+            break;
+         }
+         if (size > 1) { // skip EOF messages
+            if (f->cnt == cap) {
+               cap = cap ? 2 * cap : 65536;
+               f->rec = realloc(f->rec, cap * sizeof(*f->rec));
+               f->size = realloc(f->size, cap * sizeof(*f->size));
+               if (f->rec == NULL || f->size == NULL) {
+                  fprintf(stderr, "Error: %s: out of memory.\n", name);
+                  return 1;
+               }
+            }
+            f->rec[f->cnt] = p;
+            f->size[f->cnt] = size;
+            f->cnt++;
+         }
+         p += size;
+      }
+      p = buf_end;
+   }
+   return 0;
+}
+
+static void replay_file_close(replay_file_t *f)
+{
+   if (f->map != NULL) {
+      munmap(f->map, f->map_size);
+   }
+   if (f->tmplt != NULL) {
+      ur_free_template(f->tmplt);
+   }
+   free(f->rec);
+   free(f->size);
+   memset(f, 0, sizeof(*f));
+}
+
+static uint64_t replay_cpu_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+   return (uint64_t)ts.tv_sec * NS + ts.tv_nsec;
+}
+
+/*!
+ * \brief Replay all files with one configuration.
+ * \param[in] job Job.
+ * \param[in] r Result to fill.
+ * \param[in] stream Stream of random number generator.
+ * \return 0 on success, 1 on allocation failure.
+ */
+static int replay_evaluate(replay_job_t *job, replay_result_t *r, uint64_t stream)
+{
+   salf_strategy_set_t set;
+   salf_batch_t batch;
+   char decision[REPLAY_BATCH];
+   double maxp[REPLAY_BATCH];
+   uint64_t next_sample = job->step;
+   uint64_t start;
+   size_t f, i, n;
+
+   memset(&batch, 0, sizeof(batch));
+   batch.decision = decision;
+   batch.maxp = maxp;
+   batch.cap = REPLAY_BATCH;
+   batch.throttle = 1.0;
+   batch.nout = 1;
+
+   if (salf_strategy_set_init(&set, &r->params, 1, job->seed, stream)) {
+      return 1;
+   }
+   r->trajectory = malloc((job->total / job->step + 1) * sizeof(*r->trajectory));
+   if (r->trajectory == NULL) {
+      salf_strategy_set_free(&set);
+      return 1;
+   }
+   r->threshold_min = r->threshold_max = set.strategy[0].state.threshold;
+
+   for (f = 0; f < job->file_cnt; f++) {
+      replay_file_t *file = &job->file[f];
+      batch.view = file->view;
+      batch.committee = file->committee;
+      batch.features = file->features;
+      for (i = 0; i < file->cnt; i += n) {
+         double th;
+         // records are not copied, batch points into the mapped file
+         n = file->cnt - i < REPLAY_BATCH ? file->cnt - i : REPLAY_BATCH;
+         if (next_sample - r->records < n) {
+            n = next_sample - r->records;
+         }
+         batch.rec = &file->rec[i];
+         batch.size = &file->size[i];
+         batch.cnt = n;
+         batch.ts = (uint64_t)((double)r->records * NS / job->flow_rate);
+         start = replay_cpu_ns();
+         r->labeled += salf_strategy_set_batch(&set, &batch);
+         r->cpu_ns += replay_cpu_ns() - start;
+         salf_release_clear(&batch.release);
+         r->records += n;
+
+         th = set.strategy[0].state.threshold;
+         if (th < r->threshold_min) {
+            r->threshold_min = th;
+         }
+         if (th > r->threshold_max) {
+            r->threshold_max = th;
+         }
+         if (r->records >= next_sample) {
+            replay_sample_t *smp = &r->trajectory[r->trajectory_cnt++];
+            smp->record = r->records;
+            smp->labeled = r->labeled;
+            smp->threshold = th;
+            next_sample += job->step;
+         }
+      }
+   }
+   // windows open at the end of stream are closed
+   batch.cnt = 0;
+   batch.flush = 1;
+   r->labeled += salf_strategy_set_batch(&set, &batch);
+   salf_release_free(&batch.release);
+   r->threshold_last = set.strategy[0].state.threshold;
+   salf_strategy_set_free(&set);
+   return 0;
+}
+
+static void *replay_thread(void *arg)
+{
+   replay_job_t *job = arg;
+   size_t i;
+
+   while ((i = atomic_fetch_add(&job->next, 1)) < job->result_cnt) {
+      if (replay_evaluate(job, &job->result[i], i)) {
+         fprintf(stderr, "Error: out of memory while evaluating '%s'.\n", job->result[i].spec);
+      }
+   }
+   return NULL;
+}
+
+/*!
+ * \brief Read configurations from file, one per line.
+ * \param[in] name File name.
+ * \param[out] specs Configurations (strings are allocated).
+ * \param[in,out] cnt Number of configurations.
+ * \return 0 on success, 1 on error.
+ */
+static int replay_read_configs(const char *name, const char **specs, size_t *cnt)
+{
+   char line[1024];
+   FILE *fp = fopen(name, "r");
+
+   if (fp == NULL) {
+      fprintf(stderr, "Error: %s: %s\n", name, strerror(errno));
+      return 1;
+   }
+   while (fgets(line, sizeof(line), fp) != NULL) {
+      line[strcspn(line, "\r\n")] = '\0';
+      if (line[0] == '\0' || line[0] == '#') {
+         continue;
+      }
+      if (*cnt == REPLAY_CONFIGS_MAX) {
+         fprintf(stderr, "Error: At most %d configurations are supported.\n", REPLAY_CONFIGS_MAX);
+         fclose(fp);
+         return 1;
+      }
+      specs[(*cnt)++] = strdup(line);
+   }
+   fclose(fp);
+   return 0;
+}
+
+static void replay_print(const replay_job_t *job, FILE *csv)
+{
+   size_t i, j;
+
+   printf("%-32s %12s %12s %9s %10s %10s %10s %9s\n",
+          "config", "records", "labeled", "labeled%", "thr_last", "thr_min", "thr_max", "ns/rec");
+   for (i = 0; i < job->result_cnt; i++) {
+      const replay_result_t *r = &job->result[i];
+      printf("%-32s %12" PRIu64 " %12" PRIu64 " %8.3f%% %10.4g %10.4g %10.4g %9.2f\n",
+             r->spec, r->records, r->labeled,
+             r->records > 0 ? (double)r->labeled / r->records * 100 : 0,
+             r->threshold_last, r->threshold_min, r->threshold_max,
+             r->records > 0 ? (double)r->cpu_ns / r->records : 0);
+   }
+   if (csv == NULL) {
+      return;
+   }
+   fprintf(csv, "config,record,labeled,labeled_fraction,threshold\n");
+   for (i = 0; i < job->result_cnt; i++) {
+      const replay_result_t *r = &job->result[i];
+      for (j = 0; j < r->trajectory_cnt; j++) {
+         const replay_sample_t *smp = &r->trajectory[j];
+         fprintf(csv, "\"%s\",%" PRIu64 ",%" PRIu64 ",%.6f,%.6g\n", r->spec, smp->record, smp->labeled,
+                 (double)smp->labeled / smp->record, smp->threshold);
+      }
+   }
+}
+
+int main(int argc, char **argv)
+{
+   static const char *specs[REPLAY_CONFIGS_MAX];
+   salf_params_t defaults = SALF_PARAMS_DEFAULT;
+   replay_job_t job;
+   pthread_t *threads = NULL;
+   size_t spec_cnt = 0;
+   long threads_cnt = sysconf(_SC_NPROCESSORS_ONLN);
+   const char *csv_name = NULL;
+   FILE *csv = NULL;
+   int ret = EXIT_FAILURE;
+   size_t i, j;
+   char *name;
+   int opt;
+
+   memset(&job, 0, sizeof(job));
+   job.step = REPLAY_TRAJECTORY_STEP;
+   job.flow_rate = REPLAY_FLOW_RATE;
+
+   while ((opt = getopt(argc, argv, "c:C:j:T:o:S:F:m:X:h")) != -1) {
+      switch (opt) {
+      case 'c':
+         if (spec_cnt == REPLAY_CONFIGS_MAX) {
+            fprintf(stderr, "Error: At most %d configurations are supported.\n", REPLAY_CONFIGS_MAX);
+            return EXIT_FAILURE;
+         }
+         specs[spec_cnt++] = optarg;
+         break;
+      case 'C':
+         if (replay_read_configs(optarg, specs, &spec_cnt)) {
+            return EXIT_FAILURE;
+         }
+         break;
+      case 'j':
+         threads_cnt = strtol(optarg, NULL, 10);
+         break;
+      case 'T':
+         job.step = strtoull(optarg, NULL, 10);
+         break;
+      case 'o':
+         csv_name = optarg;
+         break;
+      case 'S':
+         job.seed = strtoull(optarg, NULL, 10);
+         break;
+      case 'F':
+         job.flow_rate = strtod(optarg, NULL);
+         if (job.flow_rate <= 0) {
+            fprintf(stderr, "Error: Flow rate has to be positive.\n");
+            return EXIT_FAILURE;
+         }
+         break;
+      case 'm':
+         committee_cnt = 0;
+         for (name = strtok(optarg, ","); name != NULL; name = strtok(NULL, ",")) {
+            if (committee_cnt == SALF_COMMITTEE_MAX) {
+               fprintf(stderr, "Error: Committee has at most %d members.\n", SALF_COMMITTEE_MAX);
+               return EXIT_FAILURE;
+            }
+            committee_names[committee_cnt++] = name;
+         }
+         break;
+      case 'X':
+         features_cnt = 0;
+         for (name = strtok(optarg, ","); name != NULL; name = strtok(NULL, ",")) {
+            if (features_cnt == SALF_FEATURES_MAX) {
+               fprintf(stderr, "Error: At most %d feature fields.\n", SALF_FEATURES_MAX);
+               return EXIT_FAILURE;
+            }
+            features_names[features_cnt++] = name;
+         }
+         break;
+      default:
+         usage(argv[0]);
+         return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+   }
+   if (optind >= argc || spec_cnt == 0 || threads_cnt < 1 || job.step == 0) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   probas_init();
+   fvec_init();
+   rng_init();
+
+   job.result = calloc(spec_cnt, sizeof(*job.result));
+   job.file = calloc(argc - optind, sizeof(*job.file));
+   threads = calloc(threads_cnt, sizeof(*threads));
+   if (job.result == NULL || job.file == NULL || threads == NULL) {
+      fprintf(stderr, "Error: out of memory.\n");
+      goto cleanup;
+   }
+   job.result_cnt = spec_cnt;
+   for (i = 0; i < spec_cnt; i++) {
+      job.result[i].spec = specs[i];
+      job.result[i].params = defaults;
+      if (salf_params_parse(&job.result[i].params, specs[i])) {
+         fprintf(stderr, "Error: Invalid strategy configuration '%s'.\n", specs[i]);
+         goto cleanup;
+      }
+      if (salf_params_validate(&job.result[i].params, committee_cnt, features_cnt)) {
+         goto cleanup;
+      }
+   }
+
+   for (i = 0; i < (size_t)(argc - optind); i++) {
+      if (replay_file_open(&job.file[i], argv[optind + i])) {
+         job.file_cnt = i + 1;
+         goto cleanup;
+      }
+      job.file_cnt = i + 1;
+      job.total += job.file[i].cnt;
+      for (j = 0; j < spec_cnt; j++) {
+         if (salf_params_check_view(&job.result[j].params, &job.file[i].view)) {
+            fprintf(stderr, "Error: %s: format does not fit configuration '%s'.\n", argv[optind + i], specs[j]);
+            goto cleanup;
+         }
+      }
+   }
+   fprintf(stderr, "Info: %" PRIu64 " records in %zu files, %zu configurations, %ld threads.\n",
+           job.total, job.file_cnt, job.result_cnt, threads_cnt);
+
+   if (csv_name != NULL && (csv = fopen(csv_name, "w")) == NULL) {
+      fprintf(stderr, "Error: %s: %s\n", csv_name, strerror(errno));
+      goto cleanup;
+   }
+
+   atomic_init(&job.next, 0);
+   for (i = 0; i < (size_t)threads_cnt; i++) {
+      if (pthread_create(&threads[i], NULL, replay_thread, &job) != 0) {
+         fprintf(stderr, "Error: Could not start thread.\n");
+         threads_cnt = i;
+         break;
+      }
+   }
+   for (i = 0; i < (size_t)threads_cnt; i++) {
+      pthread_join(threads[i], NULL);
+   }
+   if (threads_cnt > 0) {
+      replay_print(&job, csv);
+      ret = EXIT_SUCCESS;
+   }
+
+cleanup:
+   if (csv != NULL) {
+      fclose(csv);
+   }
+   for (i = 0; job.file != NULL && i < job.file_cnt; i++) {
+      replay_file_close(&job.file[i]);
+   }
+   for (i = 0; job.result != NULL && i < job.result_cnt; i++) {
+      free(job.result[i].trajectory);
+   }
+   free(job.file);
+   free(job.result);
+   free(threads);
+   return ret;
+}
@@ -0,0 +1,128 @@
+/*!
+ * \file scaler.h
+ * \brief Running standardization of feature vectors
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _SCALER_H_
+#define _SCALER_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "salf.h"
+
+/*
+ * Features are standardized by exponentially weighted mean and variance
+ * over about SALF_SCALER_HORIZON flows (plain averages before that), so
+ * fields of different units get comparable weight. Inverse standard
+ * deviations are recomputed once per batch, a record costs a few multiply-adds
+ * per feature. During the first SALF_SCALER_WARMUP flows they are recomputed
+ * per flow, so a large first batch is not standardized by zero scales.
+ */
+
+/*!
+ * \brief Running mean and variance of features.
+ */
+typedef struct salf_scaler_s {
+   float mean[SALF_FEATURES_MAX]; /*< Mean of features. */
+   float var[SALF_FEATURES_MAX]; /*< Variance of features. */
+   float scale[SALF_FEATURES_MAX]; /*< Inverse standard deviation of features (updated per batch). */
+   uint64_t n; /*< Number of standardized vectors. */
+} salf_scaler_t;
+
+/*!
+ * \brief Reset statistics.
+ * \param[out] sc Scaler.
+ */
+static inline void salf_scaler_init(salf_scaler_t *sc)
+{
+   memset(sc, 0, sizeof(*sc));
+}
+
+/*!
+ * \brief Update inverse standard deviations from variances.
+ * \param[in,out] sc Scaler.
+ * \param[in] cnt Number of features.
+ */
+static inline void salf_scaler_rescale(salf_scaler_t *sc, size_t cnt)
+{
+   size_t f;
+
+   for (f = 0; f < cnt; f++) {
+      sc->scale[f] = sc->var[f] > 0 ? 1.0f / sqrtf(sc->var[f]) : 0;
+   }
+}
+
+/*!
+ * \brief Standardize feature vector.
+ * \param[in,out] sc Scaler, mean and variance are updated by x.
+ * \param[in] x Feature vector.
+ * \param[out] z Standardized vector.
+ * \param[in] cnt Number of features.
+ */
+static inline void salf_scaler_apply(salf_scaler_t *sc, const float *x, float *z, size_t cnt)
+{
+   float w;
+   size_t f;
+
+   sc->n++;
+   w = 1.0f / (float)(sc->n < SALF_SCALER_HORIZON ? sc->n : SALF_SCALER_HORIZON);
+   for (f = 0; f < cnt; f++) {
+      float d = x[f] - sc->mean[f];
+      z[f] = d * sc->scale[f];
+      sc->mean[f] += w * d;
+      sc->var[f] += w * (d * (x[f] - sc->mean[f]) - sc->var[f]);
+   }
+   if (sc->n <= SALF_SCALER_WARMUP) {
+      salf_scaler_rescale(sc, cnt);
+   }
+}
+
+/*!
+ * \brief Check whether standardization is trained.
+ * \param[in] sc Scaler.
+ * \return Nonzero once the last standardized vector was scaled by statistics of SALF_SCALER_WARMUP vectors.
+ */
+static inline int salf_scaler_warm(const salf_scaler_t *sc)
+{
+   return sc->n > SALF_SCALER_WARMUP;
+}
+
+#endif /* _SCALER_H_ */
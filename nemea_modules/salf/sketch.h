@@ -0,0 +1,174 @@
+/*!
+ * \file sketch.h
+ * \brief Time-decayed count-min sketch of labeled endpoint pairs
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _SKETCH_H_
+#define _SKETCH_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "salf.h"
+
+/*
+ * Count-min sketch of SALF_SKETCH_DEPTH rows of SALF_SKETCH_WIDTH 16-bit
+ * counters counts labels of keys given by 64-bit hash. Indices of rows are
+ * derived from the two halves of the hash (double hashing), the estimate is
+ * the minimum of the counters and never undercounts. Update is conservative
+ * (only the minimal counters are incremented), which keeps overestimation of
+ * rare keys low. All counters are halved every half-life, so counts of pairs
+ * which stopped repeating fade out; halving costs O(size) once per half-life,
+ * i.e. O(1) amortized per flow.
+ */
+
+/*!
+ * \brief Count-min sketch.
+ */
+typedef struct salf_sketch_s {
+   uint16_t *cnt; /*< Counters, SALF_SKETCH_DEPTH rows, NULL until first use. */
+   uint64_t ts; /*< Time of last halving in ns. */
+} salf_sketch_t;
+
+/*!
+ * \brief Allocate zeroed counters.
+ * \param[in,out] sk Sketch.
+ * \param[in] ts Current time in ns.
+ * \return 0 on success, 1 on allocation failure.
+ */
+static inline int salf_sketch_alloc(salf_sketch_t *sk, uint64_t ts)
+{
+   sk->cnt = calloc(SALF_SKETCH_DEPTH * SALF_SKETCH_WIDTH, sizeof(*sk->cnt));
+   sk->ts = ts;
+   return sk->cnt == NULL;
+}
+
+/*!
+ * \brief Free counters.
+ * \param[in,out] sk Sketch.
+ */
+static inline void salf_sketch_free(salf_sketch_t *sk)
+{
+   free(sk->cnt);
+   sk->cnt = NULL;
+}
+
+/*!
+ * \brief Halve counters once per elapsed half-life.
+ * \param[in,out] sk Sketch.
+ * \param[in] ts Current time in ns.
+ * \param[in] halflife Half-life in ns, 0 disables decay.
+ */
+static inline void salf_sketch_decay(salf_sketch_t *sk, uint64_t ts, uint64_t halflife)
+{
+   unsigned int shift = 0;
+   size_t i;
+
+   if (halflife == 0 || ts < sk->ts + halflife) {
+      return;
+   }
+   while (ts >= sk->ts + halflife && shift < 16) {
+      sk->ts += halflife;
+      shift++;
+   }
+   if (shift == 16) {
+      sk->ts = ts;
+   }
+   for (i = 0; i < SALF_SKETCH_DEPTH * SALF_SKETCH_WIDTH; i++) {
+      sk->cnt[i] >>= shift;
+   }
+}
+
+/*!
+ * \brief Index of counter of key in row.
+ * \param[in] hash Hash of key.
+ * \param[in] row Row.
+ * \return Index into counters.
+ */
+static inline size_t salf_sketch_index(uint64_t hash, size_t row)
+{
+   uint32_t h1 = (uint32_t)hash;
+   uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+
+   return row * SALF_SKETCH_WIDTH + ((h1 + row * h2) & (SALF_SKETCH_WIDTH - 1));
+}
+
+/*!
+ * \brief Estimate count of key.
+ * \param[in] sk Sketch.
+ * \param[in] hash Hash of key.
+ * \return Count, never lower than the true count (before decay).
+ */
+static inline unsigned int salf_sketch_get(const salf_sketch_t *sk, uint64_t hash)
+{
+   unsigned int min = UINT16_MAX;
+   size_t row;
+
+   for (row = 0; row < SALF_SKETCH_DEPTH; row++) {
+      unsigned int c = sk->cnt[salf_sketch_index(hash, row)];
+      if (c < min) {
+         min = c;
+      }
+   }
+   return min;
+}
+
+/*!
+ * \brief Count key (conservative update, counters saturate).
+ * \param[in,out] sk Sketch.
+ * \param[in] hash Hash of key.
+ */
+static inline void salf_sketch_add(salf_sketch_t *sk, uint64_t hash)
+{
+   unsigned int min = salf_sketch_get(sk, hash);
+   size_t row;
+
+   if (min == UINT16_MAX) {
+      return;
+   }
+   for (row = 0; row < SALF_SKETCH_DEPTH; row++) {
+      uint16_t *c = &sk->cnt[salf_sketch_index(hash, row)];
+      if (*c == min) {
+         (*c)++;
+      }
+   }
+}
+
+#endif /* _SKETCH_H_ */
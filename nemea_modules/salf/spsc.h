@@ -0,0 +1,114 @@
+/*!
+ * \file spsc.h
+ * \brief Lock-free single-producer single-consumer ring of pointers
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _SPSC_H_
+#define _SPSC_H_
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#define SPSC_CACHE_LINE 64 /*< Size of cache line, head and tail are kept on separate lines. */
+
+/*!
+ * \brief Ring of pointers.
+ * Only one thread may push and only one thread may pop.
+ */
+typedef struct spsc_s {
+   _Alignas(SPSC_CACHE_LINE) atomic_size_t head; /*< Next slot to write, owned by producer. */
+   _Alignas(SPSC_CACHE_LINE) atomic_size_t tail; /*< Next slot to read, owned by consumer. */
+   _Alignas(SPSC_CACHE_LINE) size_t mask; /*< Capacity - 1. */
+   void **slot; /*< Storage. */
+} spsc_t;
+
+/*!
+ * \brief Initialize ring.
+ * \param[out] q Ring.
+ * \param[in] slot Storage of capacity pointers.
+ * \param[in] capacity Capacity, power of 2.
+ */
+static inline void spsc_init(spsc_t *q, void **slot, size_t capacity)
+{
+   atomic_init(&q->head, 0);
+   atomic_init(&q->tail, 0);
+   q->mask = capacity - 1;
+   q->slot = slot;
+}
+
+/*!
+ * \brief Push pointer (producer).
+ * \param[in] q Ring.
+ * \param[in] p Pointer.
+ * \return 0 on success, 1 if ring is full.
+ */
+static inline int spsc_push(spsc_t *q, void *p)
+{
+   size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+   size_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+   if (head - tail > q->mask) {
+      return 1;
+   }
+   q->slot[head & q->mask] = p;
+   atomic_store_explicit(&q->head, head + 1, memory_order_release);
+   return 0;
+}
+
+/*!
+ * \brief Pop pointer (consumer).
+ * \param[in] q Ring.
+ * \return Pointer or NULL if ring is empty.
+ */
+static inline void *spsc_pop(spsc_t *q)
+{
+   size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+   size_t head = atomic_load_explicit(&q->head, memory_order_acquire);
+   void *p;
+
+   if (head == tail) {
+      return NULL;
+   }
+   p = q->slot[tail & q->mask];
+   atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+   return p;
+}
+
+#endif /* _SPSC_H_ */
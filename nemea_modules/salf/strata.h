@@ -0,0 +1,161 @@
+/*!
+ * \file strata.h
+ * \brief Per-class label quotas (class-stratified budget)
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _STRATA_H_
+#define _STRATA_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "salf.h"
+
+/*
+ * Budget is split among predicted classes, class c may take the fraction
+ * w(c) of labels. Flows and labels are counted per class in arrays indexed
+ * by class id, the number of seen classes and the sum of inverse class
+ * counts are kept up to date on every flow, so the quota check is O(1).
+ * Counters are halved every SALF_STRATA_HORIZON flows (O(SALF_STRATA_MAX)),
+ * so quotas follow changes of class frequencies.
+ */
+
+#define SALF_STRATIFY_NONE 0 /*< Budget is shared by all classes. */
+#define SALF_STRATIFY_UNIFORM 1 /*< Every seen class gets the same share of labels. */
+#define SALF_STRATIFY_INVERSE 2 /*< Share of labels is inversely proportional to class frequency. */
+
+/*!
+ * \brief Per-class counters.
+ */
+typedef struct salf_strata_s {
+   uint32_t seen[SALF_STRATA_MAX]; /*< Number of flows per class. */
+   uint32_t labeled[SALF_STRATA_MAX]; /*< Number of labeled flows per class. */
+   uint32_t total; /*< Number of flows. */
+   uint32_t classes; /*< Number of classes with nonzero count. */
+   double inverse; /*< Sum of 1 / seen over classes with nonzero count. */
+} salf_strata_t;
+
+/*!
+ * \brief Initialize empty counters.
+ * \param[out] st Counters.
+ */
+static inline void salf_strata_init(salf_strata_t *st)
+{
+   memset(st, 0, sizeof(*st));
+}
+
+/*!
+ * \brief Halve all counters, classes which drop to zero are forgotten.
+ * \param[in,out] st Counters.
+ */
+static inline void salf_strata_halve(salf_strata_t *st)
+{
+   size_t c;
+
+   st->total = 0;
+   st->classes = 0;
+   st->inverse = 0;
+   for (c = 0; c < SALF_STRATA_MAX; c++) {
+      st->seen[c] >>= 1;
+      st->labeled[c] >>= 1;
+      if (st->seen[c] != 0) {
+         st->total += st->seen[c];
+         st->classes++;
+         st->inverse += 1.0 / st->seen[c];
+      }
+   }
+}
+
+/*!
+ * \brief Count flow of class.
+ * Must be called before salf_strata_below() of the flow, so the class is known.
+ * \param[in,out] st Counters.
+ * \param[in] c Class id, less than SALF_STRATA_MAX.
+ */
+static inline void salf_strata_add(salf_strata_t *st, size_t c)
+{
+   uint32_t n = st->seen[c];
+
+   if (st->total >= SALF_STRATA_HORIZON) {
+      salf_strata_halve(st);
+      n = st->seen[c];
+   }
+   if (n == 0) {
+      st->classes++;
+      st->inverse += 1.0;
+   } else {
+      st->inverse += 1.0 / (n + 1) - 1.0 / n;
+   }
+   st->seen[c] = n + 1;
+   st->total++;
+}
+
+/*!
+ * \brief Check whether labeling the next flow of class keeps the class under its quota.
+ * \param[in] st Counters.
+ * \param[in] c Class id.
+ * \param[in] budget Max fraction of labeled flows of all classes.
+ * \param[in] alloc Allocation of budget, SALF_STRATIFY_*.
+ * \return Nonzero if class may take the label.
+ */
+static inline int salf_strata_below(const salf_strata_t *st, size_t c, double budget, int alloc)
+{
+   double quota = budget * (double)st->total;
+
+   if (alloc == SALF_STRATIFY_INVERSE) {
+      // share of class is (1 / seen[c]) / inverse
+      quota /= (double)st->seen[c] * st->inverse;
+   } else {
+      quota /= (double)st->classes;
+   }
+   return (double)st->labeled[c] < quota;
+}
+
+/*!
+ * \brief Count label of class.
+ * \param[in,out] st Counters.
+ * \param[in] c Class id.
+ * \param[in] label Decision (0 or 1).
+ */
+static inline void salf_strata_push(salf_strata_t *st, size_t c, unsigned int label)
+{
+   st->labeled[c] += label;
+}
+
+#endif /* _STRATA_H_ */
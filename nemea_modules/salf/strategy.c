@@ -0,0 +1,904 @@
+/*!
+ * \file strategy.c
+ * \brief Query strategies of SALF
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "strategy.h"
+#include "checkpoint.h"
+
+int salf_params_parse(salf_params_t *params, const char *spec)
+{
+   char key;
+   char *end;
+   const char *p = spec;
+
+   while (*p != '\0') {
+      key = *p++;
+      if (*p++ != '=') {
+         return 1;
+      }
+      switch (key) {
+      case 'q':
+         params->query_strategy = (int)strtol(p, &end, 10);
+         break;
+      case 'b':
+         params->budget = strtod(p, &end);
+         break;
+      case 't':
+         params->labeling_threshold = strtod(p, &end);
+         break;
+      case 's':
+         params->step = strtod(p, &end);
+         break;
+      case 'd':
+         params->t_deviation = strtod(p, &end);
+         break;
+      case 'r':
+         params->rate = strtod(p, &end);
+         break;
+      case 'R':
+         params->burst = strtod(p, &end);
+         break;
+      case 'a':
+         params->auto_threshold = (int)strtol(p, &end, 10);
+         break;
+      case 'g':
+         params->kp = strtod(p, &end);
+         break;
+      case 'G':
+         params->ki = strtod(p, &end);
+         break;
+      case 'W':
+         params->window = (unsigned int)strtoul(p, &end, 10);
+         break;
+      case 'e':
+         params->committee_measure = (int)strtol(p, &end, 10);
+         break;
+      case 'y':
+         params->stratify = (int)strtol(p, &end, 10);
+         break;
+      case 'k':
+         params->select_k = (unsigned int)strtoul(p, &end, 10);
+         break;
+      case 'n':
+         params->select_window = (unsigned int)strtoul(p, &end, 10);
+         break;
+      case 'i':
+         params->select_interval = strtod(p, &end);
+         break;
+      case 'x':
+         params->hash_key = (unsigned int)strtoul(p, &end, 0);
+         break;
+      case 'o':
+         params->hash_oneway = (int)strtol(p, &end, 10);
+         break;
+      case 'u':
+         params->dedup = (unsigned int)strtoul(p, &end, 10);
+         break;
+      case 'l':
+         params->dedup_halflife = strtod(p, &end);
+         break;
+      case 'h':
+         params->host_share = strtod(p, &end);
+         break;
+      case 'j':
+         params->host_window = (unsigned int)strtoul(p, &end, 10);
+         break;
+      case 'L':
+         params->lsh_bands = (unsigned int)strtoul(p, &end, 10);
+         break;
+      case 'T':
+         params->lsh_ttl = strtod(p, &end);
+         break;
+      case 'C':
+         params->clusters = (unsigned int)strtoul(p, &end, 10);
+         break;
+      default:
+         return 1;
+      }
+      if (end == p || (*end != ',' && *end != '\0')) {
+         return 1;
+      }
+      p = *end == ',' ? end + 1 : end;
+   }
+   return 0;
+}
+
+int salf_params_load(const char *path, salf_params_t *params, size_t max, size_t *cnt)
+{
+   char line[1024];
+   FILE *fp = fopen(path, "r");
+
+   *cnt = 0;
+   if (fp == NULL) {
+      fprintf(stderr, "Error: Could not open %s.\n", path);
+      return 1;
+   }
+   while (fgets(line, sizeof(line), fp) != NULL) {
+      line[strcspn(line, " \t\r\n")] = '\0';
+      if (line[0] == '\0' || line[0] == '#') {
+         continue;
+      }
+      if (*cnt == max) {
+         fprintf(stderr, "Error: %s: more than %zu configurations.\n", path, max);
+         fclose(fp);
+         return 1;
+      }
+      if (salf_params_parse(&params[*cnt], line)) {
+         fprintf(stderr, "Error: %s: invalid strategy configuration '%s'.\n", path, line);
+         fclose(fp);
+         return 1;
+      }
+      (*cnt)++;
+   }
+   fclose(fp);
+   return 0;
+}
+
+int salf_params_validate(const salf_params_t *params, size_t committee_cnt, size_t features_cnt)
+{
+   if (params->query_strategy == SALF_Q_COMMITTEE && committee_cnt < 2) {
+      fprintf(stderr, "Error: Query by committee needs at least 2 committee fields.\n");
+      return 1;
+   }
+   if (params->lsh_bands != 0 && (features_cnt == 0 || params->lsh_bands > SALF_LSH_BANDS_MAX || (params->lsh_bands & (params->lsh_bands - 1)) != 0)) {
+      fprintf(stderr, "Error: Near-duplicate suppression needs 1, 2, 4 or 8 bands and feature fields.\n");
+      return 1;
+   }
+   if (params->lsh_ttl < 0) {
+      fprintf(stderr, "Error: TTL of feature signatures must not be negative.\n");
+      return 1;
+   }
+   if (salf_strategy_windowed(params->query_strategy) && params->select_window == 0) {
+      // k derived from budget needs the number of records per window
+      if (params->select_k == 0) {
+         fprintf(stderr, "Error: Time windows (select window 0) need the number of selected records (select k).\n");
+         return 1;
+      }
+      if (params->select_interval <= 0) {
+         fprintf(stderr, "Error: Time windows (select window 0) need a positive select interval.\n");
+         return 1;
+      }
+   }
+   if (params->query_strategy == SALF_Q_DIVERSITY && (features_cnt == 0 || params->clusters < 1 || params->clusters > SALF_CLUSTERS_MAX)) {
+      fprintf(stderr, "Error: Diversity strategy needs 1 to %d clusters and feature fields.\n", SALF_CLUSTERS_MAX);
+      return 1;
+   }
+   return 0;
+}
+
+int salf_params_check_view(const salf_params_t *params, const salf_view_t *view)
+{
+   if (params->query_strategy == SALF_Q_HASH && salf_flowkey_fields(view, params->hash_key) == 0) {
+      // every flow would hash the same, labeling all or nothing
+      fprintf(stderr, "Error: Flow hash strategy needs a field of its flow key (hash key %u) in the input format.\n", params->hash_key);
+      return 1;
+   }
+   if (params->dedup > 0 && !salf_strategy_windowed(params->query_strategy) && salf_flowkey_fields(view, SALF_DEDUP_KEY) != SALF_DEDUP_KEY) {
+      // pairs would collapse to the fields present, suppressing unrelated flows;
+      // windowed strategies do not use the sketch, like the host cap
+      fprintf(stderr, "Error: Dedup needs SRC_IP, DST_IP and DST_PORT in the input format.\n");
+      return 1;
+   }
+   return 0;
+}
+
+const char *salf_committee_resolve(salf_committee_t *c, const ur_template_t *tmplt, const char **names, size_t cnt)
+{
+   size_t i;
+
+   c->static_size = tmplt->static_size;
+   c->cnt = cnt;
+   for (i = 0; i < cnt; i++) {
+      c->offset[i] = ur_view_resolve_name(tmplt, names[i], UR_TYPE_A_DOUBLE);
+      if (c->offset[i] == UR_VIEW_NO_FIELD) {
+         c->cnt = 0;
+         return names[i];
+      }
+   }
+   return NULL;
+}
+
+const char *salf_features_resolve(salf_features_t *f, const ur_template_t *tmplt, const char **names, size_t cnt)
+{
+   size_t i;
+
+   f->cnt = cnt;
+   for (i = 0; i < cnt; i++) {
+      int id = ur_get_id_by_name(names[i]);
+      int type = id >= 0 && ur_is_present(tmplt, id) ? ur_get_type(id) : -1;
+      switch (type) {
+      case UR_TYPE_UINT8:
+      case UR_TYPE_INT8:
+      case UR_TYPE_UINT16:
+      case UR_TYPE_INT16:
+      case UR_TYPE_UINT32:
+      case UR_TYPE_INT32:
+      case UR_TYPE_UINT64:
+      case UR_TYPE_INT64:
+      case UR_TYPE_FLOAT:
+      case UR_TYPE_DOUBLE:
+         f->offset[i] = tmplt->offset[id];
+         f->type[i] = type;
+         break;
+      default:
+         f->cnt = 0;
+         return names[i];
+      }
+   }
+   return NULL;
+}
+
+/*!
+ * \brief Start budget quantile estimation of instance.
+ * \param[in,out] s Instance.
+ */
+static void salf_strategy_quantile_init(salf_strategy_t *s)
+{
+   double p = s->params.budget;
+
+   // quantile has to be inside (0,1)
+   if (p < SALF_QUANTILE_MIN) {
+      p = SALF_QUANTILE_MIN;
+   } else if (p > 1 - SALF_QUANTILE_MIN) {
+      p = 1 - SALF_QUANTILE_MIN;
+   }
+   p2_init(&s->state.quantile, p, SALF_QUANTILE_WINDOW);
+}
+
+void salf_strategy_init(salf_strategy_t *s, const salf_params_t *params, uint64_t seed, uint64_t stream)
+{
+   s->params = *params;
+   s->state.threshold = 1.0;
+   s->state.u = 0;
+   s->state.t = 0;
+   salf_window_init(&s->state.window, s->params.window);
+   s->state.tokens = HUGE_VAL; // bucket starts full, clamped to burst at first refill
+   s->state.tokens_ts = 0;
+   s->state.share = 1.0;
+   s->state.offered = 0;
+   s->state.rate = 0;
+   s->state.integral = 0;
+   salf_strata_init(&s->state.strata);
+   memset(&s->state.hold, 0, sizeof(s->state.hold));
+   memset(&s->state.sketch, 0, sizeof(s->state.sketch));
+   salf_hosts_init(&s->state.hosts);
+   memset(&s->state.lsh, 0, sizeof(s->state.lsh));
+   memset(&s->state.kmeans, 0, sizeof(s->state.kmeans));
+   s->out = 0;
+   salf_strategy_quantile_init(s);
+   rng_seed(&s->state.rng, seed, stream);
+}
+
+/*!
+ * \brief Prepare endpoint pair sketch of instance for batch.
+ * Sketch is allocated at first use and decayed by time of batch.
+ * \param[in,out] s Instance.
+ * \param[in] view Description of records of batch.
+ * \param[in] ts Time of batch in ns.
+ * \return Max number of labels per endpoint pair, 0 if dedup is off (or records lack a field of the pair, or sketch could not be allocated).
+ */
+static unsigned int salf_strategy_dedup(salf_strategy_t *s, const salf_view_t *view, uint64_t ts)
+{
+   salf_sketch_t *sk = &s->state.sketch;
+
+   if (s->params.dedup == 0 || salf_flowkey_fields(view, SALF_DEDUP_KEY) != SALF_DEDUP_KEY) {
+      return 0;
+   }
+   if (sk->cnt == NULL && salf_sketch_alloc(sk, ts)) {
+      return 0;
+   }
+   salf_sketch_decay(sk, ts, (uint64_t)(s->params.dedup_halflife * NS));
+   return s->params.dedup;
+}
+
+/*!
+ * \brief Max number of labels of one source host in host window.
+ * \param[in] s Instance.
+ * \param[in] view Description of records of batch.
+ * \return Cap of labels per host, 0 if cap is off (or records have no SRC_IP).
+ */
+static uint32_t salf_strategy_host_cap(const salf_strategy_t *s, const salf_view_t *view)
+{
+   double cap = s->params.host_share * s->params.host_window;
+
+   if (cap <= 0 || s->params.host_window == 0 || !salf_view_has_SRC_IP(view)) {
+      return 0;
+   }
+   // every host may have at least one label per window
+   return cap < 1 ? 1 : (uint32_t)cap;
+}
+
+/*!
+ * \brief Prepare feature signature table of instance for batch.
+ * Table is allocated at first use, feature scales are updated once per batch.
+ * \param[in,out] s Instance.
+ * \param[in] f Feature fields of batch.
+ * \return Number of bands, 0 if suppression is off (no features, invalid bands or allocation failure).
+ */
+static unsigned int salf_strategy_lsh(salf_strategy_t *s, const salf_features_t *f)
+{
+   salf_lsh_t *lsh = &s->state.lsh;
+   unsigned int bands = s->params.lsh_bands;
+
+   if (bands == 0 || bands > SALF_LSH_BANDS_MAX || (bands & (bands - 1)) != 0 || f->cnt == 0) {
+      return 0;
+   }
+   if (lsh->slot == NULL && salf_lsh_alloc(lsh)) {
+      return 0;
+   }
+   salf_scaler_rescale(&lsh->scaler, f->cnt);
+   return bands;
+}
+
+/*!
+ * \brief Define batch loop of strategy.
+ * Defines function NAME_batch() with NAME() inlined into the loop.
+ * Without rate budget tokens stay HUGE_VAL, so the token check never fails.
+ * Under backpressure only batch->throttle of records is offered to strategy,
+ * the others are skipped evenly (the accumulator reaches 1 every 1/throttle records).
+ * With stratified budget the predicted class is counted for every offered
+ * record and records of classes over quota are counted by strategy as not
+ * labeled without calling NAME(). With dedup, records of endpoint pairs
+ * labeled dedup times within the half-life are treated the same way.
+ * With host cap, so are records of source hosts which already have
+ * host_share of the labels of current host window (host_window labels).
+ * With lsh_bands, so are records whose feature signature shares a band with
+ * a flow labeled within lsh_ttl (once the standardization of features is warm).
+ * VIEW is the description of record passed to NAME().
+ */
+#define SALF_STRATEGY_BATCH_VIEW(NAME, VIEW) \
+   static size_t NAME##_batch(salf_strategy_t *s, salf_batch_t *batch, char *decision) \
+   { \
+      size_t i; \
+      size_t selected = 0; \
+      size_t c = 0; \
+      uint64_t pair = 0; \
+      uint64_t host = 0; \
+      uint64_t sig = 0; \
+      float x[SALF_FEATURES_MAX]; \
+      double throttle = batch->throttle; \
+      int stratify = s->params.stratify; \
+      unsigned int dedup = salf_strategy_dedup(s, &batch->view, batch->ts); \
+      uint32_t host_cap = salf_strategy_host_cap(s, &batch->view); \
+      unsigned int bands = salf_strategy_lsh(s, &batch->features); \
+      uint32_t ms = (uint32_t)(batch->ts / 1000000); \
+      uint32_t ttl = s->params.lsh_ttl > 0 ? (uint32_t)(s->params.lsh_ttl * 1000) : UINT32_MAX; \
+      salf_tokens_refill(s, batch->ts); \
+      for (i = 0; i < batch->cnt; i++) { \
+         if (s->state.tokens < 1.0 || !salf_strategy_offer(s, throttle)) { \
+            decision[i] = 0; \
+            continue; \
+         } \
+         if (stratify != SALF_STRATIFY_NONE) { \
+            c = get_class(batch->rec[i], &batch->view, &batch->maxp[i]); \
+            salf_strata_add(&s->state.strata, c); \
+            if (!salf_strata_below(&s->state.strata, c, s->params.budget, stratify)) { \
+               salf_strategy_skip(s); \
+               decision[i] = 0; \
+               continue; \
+            } \
+         } \
+         if (dedup > 0) { \
+            pair = salf_flowhash(batch->rec[i], &batch->view, SALF_DEDUP_KEY, 1); \
+            if (salf_sketch_get(&s->state.sketch, pair) >= dedup) { \
+               salf_strategy_skip(s); \
+               decision[i] = 0; \
+               continue; \
+            } \
+         } \
+         if (host_cap > 0) { \
+            host = salf_flowhash(batch->rec[i], &batch->view, SALF_KEY_SRC_IP, 1); \
+            if (salf_hosts_get(&s->state.hosts, host) >= host_cap) { \
+               salf_strategy_skip(s); \
+               decision[i] = 0; \
+               continue; \
+            } \
+         } \
+         if (bands > 0) { \
+            salf_features_read(batch->rec[i], &batch->features, x); \
+            sig = salf_lsh_signature(&s->state.lsh, x, batch->features.cnt); \
+            if (salf_scaler_warm(&s->state.lsh.scaler) && salf_lsh_recent(&s->state.lsh, sig, bands, ms, ttl)) { \
+               salf_strategy_skip(s); \
+               decision[i] = 0; \
+               continue; \
+            } \
+         } \
+         decision[i] = NAME(s, batch->rec[i], VIEW, &batch->maxp[i]); \
+         if (stratify != SALF_STRATIFY_NONE) { \
+            salf_strata_push(&s->state.strata, c, decision[i] != 0); \
+         } \
+         if (dedup > 0 && decision[i]) { \
+            salf_sketch_add(&s->state.sketch, pair); \
+         } \
+         if (host_cap > 0 && decision[i]) { \
+            salf_hosts_add(&s->state.hosts, host); \
+            if (s->state.hosts.labels >= s->params.host_window) { \
+               salf_hosts_init(&s->state.hosts); \
+            } \
+         } \
+         if (bands > 0 && decision[i] && salf_scaler_warm(&s->state.lsh.scaler)) { \
+            salf_lsh_add(&s->state.lsh, sig, bands, ms); \
+         } \
+         s->state.tokens -= decision[i] != 0; \
+         selected += decision[i] != 0; \
+      } \
+      return selected; \
+   }
+
+/*!
+ * \brief Define batch loop of strategy reading fields of view.
+ */
+#define SALF_STRATEGY_BATCH(NAME) SALF_STRATEGY_BATCH_VIEW(NAME, &batch->view)
+
+SALF_STRATEGY_BATCH(random_strategy)
+SALF_STRATEGY_BATCH(fixed_uncertainty_strategy)
+SALF_STRATEGY_BATCH(variable_uncertainty_strategy)
+SALF_STRATEGY_BATCH(uncertainty_strategy_with_randomization)
+SALF_STRATEGY_BATCH(pi_uncertainty_strategy)
+SALF_STRATEGY_BATCH(margin_uncertainty_strategy)
+SALF_STRATEGY_BATCH(entropy_uncertainty_strategy)
+SALF_STRATEGY_BATCH_VIEW(committee_uncertainty_strategy, &batch->committee)
+SALF_STRATEGY_BATCH(flow_hash_strategy)
+SALF_STRATEGY_BATCH_VIEW(diversity_strategy, batch)
+
+/*!
+ * \brief Prepare clusters of instance for batch.
+ * Centroids are allocated at first use (allocation failure leaves weights 1),
+ * feature scales are updated once per batch.
+ * \param[in,out] s Instance.
+ * \param[in] f Feature fields of batch.
+ */
+static void salf_strategy_kmeans(salf_strategy_t *s, const salf_features_t *f)
+{
+   salf_kmeans_t *km = &s->state.kmeans;
+
+   if (f->cnt == 0 || (km->c == NULL && salf_kmeans_alloc(km))) {
+      return;
+   }
+   salf_scaler_rescale(&km->scaler, f->cnt);
+}
+
+/*!
+ * \brief Number of records selected per window by windowed strategy.
+ * Time windows (select_window 0) have explicit select_k, see salf_params_validate().
+ * Every worker closes its own time window each select_interval, so their k is
+ * the share of instance (rounded up), like the rate budget.
+ * \param[in] s Instance.
+ * \return Number of records, 1 .. SALF_SELECT_MAX, at most records per window.
+ */
+static size_t salf_select_k(const salf_strategy_t *s)
+{
+   const salf_params_t *params = &s->params;
+   double k = params->select_k > 0 ? (double)params->select_k : ceil(params->budget * params->select_window);
+
+   if (params->select_window == 0) {
+      k = ceil(k * s->state.share);
+   }
+   if (params->select_window > 0 && k > params->select_window) {
+      k = params->select_window;
+   }
+   if (k > SALF_SELECT_MAX) {
+      k = SALF_SELECT_MAX;
+   }
+   return k < 1 ? 1 : (size_t)k;
+}
+
+/*!
+ * \brief Number of records released when window of windowed strategy closes.
+ * Window closed by time before it has select_window records releases the
+ * proportional part of k, so the selected fraction does not grow. Released
+ * records take tokens of rate budget.
+ * \param[in] s Instance.
+ * \param[in] k Number of records selected from full window.
+ * \return Number of records.
+ */
+static size_t salf_window_quota(const salf_strategy_t *s, size_t k)
+{
+   double m = (double)k;
+
+   if (s->params.select_window > 0 && s->state.hold.seen < s->params.select_window) {
+      m = ceil(m * (double)s->state.hold.seen / s->params.select_window);
+   }
+   if (m > floor(s->state.tokens)) {
+      m = floor(s->state.tokens);
+   }
+   return (size_t)m;
+}
+
+/*!
+ * \brief Release held records with batch and close window.
+ * \param[in,out] s Instance.
+ * \param[in,out] batch Batch the records are released with.
+ * \return Number of released records.
+ */
+static size_t salf_window_release(salf_strategy_t *s, salf_batch_t *batch)
+{
+   size_t released = salf_hold_release(&s->state.hold, &batch->release, s->out);
+
+   s->state.tokens -= released;
+   s->state.u += released;
+   return released;
+}
+
+/*!
+ * \brief Close window of top-k strategy, the records with the lowest keys are released.
+ * \param[in,out] s Instance.
+ * \param[in,out] batch Batch the records are released with.
+ * \param[in] k Number of records selected from full window.
+ * \return Number of released records.
+ */
+static size_t topk_window_close(salf_strategy_t *s, salf_batch_t *batch, size_t k)
+{
+   salf_hold_heap_trim(&s->state.hold, salf_window_quota(s, k));
+   return salf_window_release(s, batch);
+}
+
+/*!
+ * \brief Top-k Window Strategy (ID 8)
+ * Records of a window (select_window records or select_interval seconds,
+ * whichever comes first) are kept in a bounded max-heap of the k records
+ * with the lowest max probability, so memory is k records and every record
+ * costs O(log k). When the window closes, the held records are released
+ * with the current batch. Decisions of records in batch are always 0.
+ * \param[in,out] s Instance.
+ * \param[in,out] batch Batch.
+ * \param[out] decision Decisions, one per record.
+ * \return Number of released records.
+ */
+static size_t topk_strategy_batch(salf_strategy_t *s, salf_batch_t *batch, char *decision)
+{
+   salf_hold_t *h = &s->state.hold;
+   uint64_t interval = (uint64_t)(s->params.select_interval * NS);
+   size_t k = salf_select_k(s);
+   size_t selected = 0;
+   size_t i;
+
+   salf_tokens_refill(s, batch->ts);
+   if (h->cap != k) {
+      salf_hold_reserve(h, k);
+   }
+   if (h->seen > 0 && interval > 0 && batch->ts - h->ts >= interval) {
+      selected += topk_window_close(s, batch, k);
+   }
+   for (i = 0; i < batch->cnt; i++) {
+      decision[i] = 0;
+      if (!salf_strategy_offer(s, batch->throttle)) {
+         continue;
+      }
+      if (h->seen == 0) {
+         h->ts = batch->ts;
+      }
+      h->seen++;
+      s->state.t++;
+      salf_hold_heap_offer(h, batch->rec[i], batch->size[i], get_max_cached(batch->rec[i], &batch->view, &batch->maxp[i]));
+      if (h->seen == s->params.select_window) {
+         selected += topk_window_close(s, batch, k);
+      }
+   }
+   if (batch->flush && h->seen > 0) {
+      selected += topk_window_close(s, batch, k);
+   }
+   return selected;
+}
+
+/*!
+ * \brief Draw the next record of window which enters full reservoir (Algorithm L).
+ * Number of skipped records is geometric with parameter reservoir_w.
+ * \param[in,out] s Instance.
+ */
+static void salf_reservoir_skip(salf_strategy_t *s)
+{
+   salf_state_t *state = &s->state;
+   double gap = floor(log(rng_uniform_pos(&state->rng)) / log1p(-state->reservoir_w));
+
+   // gap is +inf for w close to 0, keep next finite
+   state->reservoir_next = state->hold.seen + 1 + (gap < 1e18 ? (uint64_t)gap : (uint64_t)1e18);
+}
+
+/*!
+ * \brief Offer record number hold.seen of window to reservoir.
+ * The first k records fill the reservoir, afterwards only the drawn records
+ * replace a random slot, so the generator runs O(k log(n/k)) times per window
+ * of n records.
+ * \param[in,out] s Instance.
+ * \param[in] data Record.
+ * \param[in] size Size of record.
+ */
+static void salf_reservoir_offer(salf_strategy_t *s, const void *data, uint16_t size)
+{
+   salf_state_t *state = &s->state;
+   salf_hold_t *h = &state->hold;
+
+   if (h->cnt < h->cap) {
+      h->cnt += salf_hold_copy(&h->rec[h->cnt], data, size, 0) == 0;
+      if (h->cnt == h->cap) {
+         state->reservoir_w = exp(log(rng_uniform_pos(&state->rng)) / h->cap);
+         salf_reservoir_skip(s);
+      }
+   } else if (h->seen == state->reservoir_next) {
+      salf_hold_copy(&h->rec[rng_below(&state->rng, h->cap)], data, size, 0);
+      state->reservoir_w *= exp(log(rng_uniform_pos(&state->rng)) / h->cap);
+      salf_reservoir_skip(s);
+   }
+}
+
+/*!
+ * \brief Close window of reservoir strategy, a uniform subset of the reservoir is released.
+ * \param[in,out] s Instance.
+ * \param[in,out] batch Batch the records are released with.
+ * \param[in] k Number of records selected from full window.
+ * \return Number of released records.
+ */
+static size_t reservoir_window_close(salf_strategy_t *s, salf_batch_t *batch, size_t k)
+{
+   salf_hold_t *h = &s->state.hold;
+   size_t m = salf_window_quota(s, k);
+   size_t j;
+
+   if (m < h->cnt) {
+      // partial Fisher-Yates shuffle moves m random slots to the front
+      for (j = 0; j < m; j++) {
+         size_t r = j + rng_below(&s->state.rng, h->cnt - j);
+         salf_hold_rec_t tmp = h->rec[j];
+         h->rec[j] = h->rec[r];
+         h->rec[r] = tmp;
+      }
+      h->cnt = m;
+   }
+   return salf_window_release(s, batch);
+}
+
+/*!
+ * \brief Reservoir Window Strategy (ID 9)
+ * Uniform sample of k records of every window (select_window records or
+ * select_interval seconds, whichever comes first) is collected by
+ * Algorithm L and released with the batch in which the window closes.
+ * Records between the drawn ones are skipped without any work when all
+ * records are offered (no backpressure). Decisions of records in batch
+ * are always 0.
+ * \param[in,out] s Instance.
+ * \param[in,out] batch Batch.
+ * \param[out] decision Decisions, one per record.
+ * \return Number of released records.
+ */
+static size_t reservoir_strategy_batch(salf_strategy_t *s, salf_batch_t *batch, char *decision)
+{
+   salf_hold_t *h = &s->state.hold;
+   uint64_t interval = (uint64_t)(s->params.select_interval * NS);
+   uint64_t window = s->params.select_window;
+   size_t k = salf_select_k(s);
+   size_t selected = 0;
+   size_t i = 0;
+
+   memset(decision, 0, batch->cnt);
+   salf_tokens_refill(s, batch->ts);
+   if (h->cap != k) {
+      salf_hold_reserve(h, k);
+   }
+   if (h->seen > 0 && interval > 0 && batch->ts - h->ts >= interval) {
+      selected += reservoir_window_close(s, batch, k);
+   }
+   while (i < batch->cnt) {
+      if (h->seen == 0) {
+         h->ts = batch->ts;
+      }
+      if (batch->throttle < 1.0) {
+         if (!salf_strategy_offer(s, batch->throttle)) {
+            i++;
+            continue;
+         }
+      } else if (h->cnt == h->cap && h->seen + 1 < s->state.reservoir_next) {
+         // skip ahead to the next drawn record, the last record of window or the end of batch
+         uint64_t skip = s->state.reservoir_next - h->seen - 1;
+         if (window > 0 && skip > window - h->seen - 1) {
+            skip = window - h->seen - 1;
+         }
+         if (skip > batch->cnt - i) {
+            skip = batch->cnt - i;
+         }
+         h->seen += skip;
+         s->state.t += skip;
+         i += skip;
+         if (skip > 0) {
+            continue;
+         }
+      }
+      h->seen++;
+      s->state.t++;
+      salf_reservoir_offer(s, batch->rec[i], batch->size[i]);
+      i++;
+      if (h->seen == window) {
+         selected += reservoir_window_close(s, batch, k);
+      }
+   }
+   if (batch->flush && h->seen > 0) {
+      selected += reservoir_window_close(s, batch, k);
+   }
+   return selected;
+}
+
+/*!
+ * \brief Close open window of windowed strategy before its parameters are replaced.
+ * \param[in,out] s Instance, still with the old parameters.
+ * \param[in,out] batch Batch the held records are released with.
+ * \return Number of released records.
+ */
+static size_t salf_window_flush(salf_strategy_t *s, salf_batch_t *batch)
+{
+   size_t k = salf_select_k(s);
+
+   if (s->state.hold.seen == 0) {
+      return 0;
+   }
+   salf_tokens_refill(s, batch->ts);
+   if (s->params.query_strategy == SALF_Q_TOPK) {
+      return topk_window_close(s, batch, k);
+   }
+   return reservoir_window_close(s, batch, k);
+}
+
+size_t salf_strategy_batch(salf_strategy_t *s, salf_batch_t *batch, char *decision)
+{
+   switch (s->params.query_strategy) {
+   case SALF_Q_FIXED:
+      return fixed_uncertainty_strategy_batch(s, batch, decision);
+   case SALF_Q_VARIABLE:
+      return variable_uncertainty_strategy_batch(s, batch, decision);
+   case SALF_Q_RANDOMIZED:
+      return uncertainty_strategy_with_randomization_batch(s, batch, decision);
+   case SALF_Q_PI:
+      return pi_uncertainty_strategy_batch(s, batch, decision);
+   case SALF_Q_MARGIN:
+      return margin_uncertainty_strategy_batch(s, batch, decision);
+   case SALF_Q_ENTROPY:
+      return entropy_uncertainty_strategy_batch(s, batch, decision);
+   case SALF_Q_COMMITTEE:
+      return committee_uncertainty_strategy_batch(s, batch, decision);
+   case SALF_Q_TOPK:
+      return topk_strategy_batch(s, batch, decision);
+   case SALF_Q_RESERVOIR:
+      return reservoir_strategy_batch(s, batch, decision);
+   case SALF_Q_HASH:
+      return flow_hash_strategy_batch(s, batch, decision);
+   case SALF_Q_DIVERSITY:
+      salf_strategy_kmeans(s, &batch->features);
+      return diversity_strategy_batch(s, batch, decision);
+   case SALF_Q_RANDOM:
+   default:
+      return random_strategy_batch(s, batch, decision);
+   }
+}
+
+int salf_strategy_set_init(salf_strategy_set_t *set, const salf_params_t *params, size_t cnt, uint64_t seed, uint64_t stream)
+{
+   size_t i;
+
+   set->strategy = malloc(cnt * sizeof(*set->strategy));
+   if (set->strategy == NULL) {
+      set->cnt = 0;
+      return 1;
+   }
+   set->cnt = cnt;
+   set->params_gen = 0;
+   set->ckpt = NULL;
+   for (i = 0; i < cnt; i++) {
+      salf_strategy_init(&set->strategy[i], &params[i], seed, stream + i);
+      set->strategy[i].out = i;
+   }
+   return 0;
+}
+
+void salf_strategy_set_share(salf_strategy_set_t *set, double share)
+{
+   size_t i;
+
+   for (i = 0; i < set->cnt; i++) {
+      set->strategy[i].state.share = share;
+   }
+}
+
+void salf_strategy_set_free(salf_strategy_set_t *set)
+{
+   size_t i;
+
+   for (i = 0; i < set->cnt; i++) {
+      salf_hold_free(&set->strategy[i].state.hold);
+      salf_sketch_free(&set->strategy[i].state.sketch);
+      salf_lsh_free(&set->strategy[i].state.lsh);
+      salf_kmeans_free(&set->strategy[i].state.kmeans);
+   }
+   free(set->strategy);
+   set->strategy = NULL;
+   set->cnt = 0;
+}
+
+size_t salf_strategy_set_update(salf_strategy_set_t *set, const salf_params_t *params, salf_batch_t *batch)
+{
+   size_t released = 0;
+   size_t i;
+
+   for (i = 0; i < set->cnt; i++) {
+      salf_strategy_t *s = &set->strategy[i];
+      int restart = s->params.budget != params[i].budget;
+      int resize = s->params.window != params[i].window;
+      if (salf_strategy_windowed(s->params.query_strategy) && s->params.query_strategy != params[i].query_strategy) {
+         // nothing would close the window of the old strategy
+         released += salf_window_flush(s, batch);
+      }
+      s->params = params[i];
+      if (restart) {
+         salf_strategy_quantile_init(s);
+      }
+      if (resize) {
+         // keep labeled fraction of the old window
+         salf_window_t *w = &s->state.window;
+         uint32_t len = w->len;
+         uint32_t cnt = w->cnt;
+         salf_window_init(w, s->params.window);
+         salf_window_fill(w, len, cnt);
+      }
+   }
+   return released;
+}
+
+size_t salf_strategy_set_batch(salf_strategy_set_t *set, salf_batch_t *batch)
+{
+   size_t i, k;
+   size_t selected = 0;
+
+   if (batch->params != NULL && batch->params_gen != set->params_gen) {
+      selected += salf_strategy_set_update(set, batch->params, batch);
+      set->params_gen = batch->params_gen;
+   }
+
+   for (i = 0; i < batch->cnt; i++) {
+      batch->maxp[i] = -1;
+   }
+   for (k = 0; k < set->cnt; k++) {
+      selected += salf_strategy_batch(&set->strategy[k], batch, batch->decision + k * batch->cap);
+   }
+   if (set->ckpt != NULL) {
+      for (k = 0; k < set->cnt; k++) {
+         salf_ckpt_save(&set->ckpt[k], &set->strategy[k]);
+      }
+   }
+   return selected;
+}
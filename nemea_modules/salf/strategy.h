@@ -0,0 +1,932 @@
+/*!
+ * \file strategy.h
+ * \brief Query strategies of SALF
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _STRATEGY_H_
+#define _STRATEGY_H_
+
+#include "salf.h"
+#include "probas.h"
+#include "rng.h"
+#include "quantile.h"
+#include "window.h"
+#include "strata.h"
+#include "hold.h"
+#include "flowkey.h"
+#include "sketch.h"
+#include "hosts.h"
+#include "lsh.h"
+#include "kmeans.h"
+#include <math.h>
+
+/*!
+ * \name Query strategy IDs
+ * \{ */
+#define SALF_Q_RANDOM 0 /*< Random Strategy. */
+#define SALF_Q_FIXED 1 /*< Fixed Uncertainty Strategy. */
+#define SALF_Q_VARIABLE 2 /*< Variable Uncertainty Strategy. */
+#define SALF_Q_RANDOMIZED 3 /*< Uncertainty Strategy with Randomization. */
+#define SALF_Q_PI 4 /*< Uncertainty Strategy with PI Controller of Label Rate. */
+#define SALF_Q_MARGIN 5 /*< Variable Uncertainty Strategy over margin of two most probable classes. */
+#define SALF_Q_ENTROPY 6 /*< Variable Uncertainty Strategy over normalized entropy. */
+#define SALF_Q_COMMITTEE 7 /*< Variable Uncertainty Strategy over disagreement of committee. */
+#define SALF_Q_TOPK 8 /*< Top-k Window Strategy, the most uncertain records of every window. */
+#define SALF_Q_RESERVOIR 9 /*< Reservoir Window Strategy, uniform sample of k records of every window. */
+#define SALF_Q_HASH 10 /*< Flow Hash Strategy, consistent selection of flows by hash of flow key. */
+#define SALF_Q_DIVERSITY 11 /*< Diversity Strategy, variable uncertainty weighted by novelty of online k-means cluster. */
+
+#define SALF_DEDUP_KEY (SALF_KEY_SRC_IP | SALF_KEY_DST_IP | SALF_KEY_DST_PORT) /*< Fields of endpoint pair. */
+
+#define SALF_COMMITTEE_VOTE 0 /*< Committee disagreement is vote entropy. */
+#define SALF_COMMITTEE_KL 1 /*< Committee disagreement is mean KL divergence from consensus. */
+/*! \} */
+
+struct salf_ckpt_rec_s;
+
+/*!
+ * \brief Parameters of strategy.
+ */
+typedef struct salf_params_s {
+   int query_strategy; /*< ID of strategy. */
+   double budget; /*< Max fraction of labeled flows. */
+   double labeling_threshold; /*< Threshold of Fixed Uncertainty Strategy. */
+   double step; /*< Adjusting step of threshold. */
+   double t_deviation; /*< Standard deviation of threshold randomization. */
+   double rate; /*< Max labeled flows per second, 0 for unlimited. */
+   double burst; /*< Size of token bucket, 0 for one second of rate. */
+   int auto_threshold; /*< Fixed Uncertainty Strategy derives threshold from budget quantile of max probabilities. */
+   double kp; /*< Proportional gain of PI controller. */
+   double ki; /*< Integral gain of PI controller. */
+   unsigned int window; /*< Number of flows the budget is checked over. */
+   int committee_measure; /*< Disagreement of committee, SALF_COMMITTEE_VOTE or SALF_COMMITTEE_KL. */
+   int stratify; /*< Allocation of budget among predicted classes, SALF_STRATIFY_*. */
+   unsigned int select_k; /*< Number of records selected per window by windowed strategies, 0 for budget * select_window. */
+   unsigned int select_window; /*< Number of records in window of windowed strategies, 0 for time windows only. */
+   double select_interval; /*< Max duration of window of windowed strategies in seconds, 0 for count windows only. */
+   unsigned int hash_key; /*< Fields of flow key, SALF_KEY_* flags. */
+   int hash_oneway; /*< Flow key keeps direction (endpoints are not ordered). */
+   unsigned int dedup; /*< Max number of labels of endpoint pair within half-life, 0 if not limited. */
+   double dedup_halflife; /*< Half-life of label counts of endpoint pairs in seconds. */
+   double host_share; /*< Max fraction of labels of one source host within host window, 0 if not limited. */
+   unsigned int host_window; /*< Number of labels in window of per-host cap. */
+   unsigned int lsh_bands; /*< Number of bands of SimHash signature of features (1, 2, 4 or 8), 0 if near-duplicates are not suppressed. */
+   double lsh_ttl; /*< Time signatures of labeled flows are kept in seconds, 0 until overwritten. */
+   unsigned int clusters; /*< Number of clusters of Diversity Strategy (at most SALF_CLUSTERS_MAX). */
+} salf_params_t;
+
+/*!
+ * \brief Initializer of default parameters, fields which are not listed are 0.
+ */
+#define SALF_PARAMS_DEFAULT { \
+   .query_strategy = SALF_Q_RANDOM, \
+   .budget = 0.5, \
+   .labeling_threshold = 0.5, \
+   .step = 0.4, \
+   .t_deviation = 1, \
+   .kp = SALF_PI_KP, \
+   .ki = SALF_PI_KI, \
+   .window = SALF_WINDOW_DEFAULT, \
+   .committee_measure = SALF_COMMITTEE_VOTE, \
+   .stratify = SALF_STRATIFY_NONE, \
+   .select_window = SALF_SELECT_WINDOW_DEFAULT, \
+   .select_interval = SALF_SELECT_INTERVAL_DEFAULT, \
+   .hash_key = SALF_KEY_DEFAULT, \
+   .dedup_halflife = SALF_DEDUP_HALFLIFE_DEFAULT, \
+   .host_window = SALF_HOSTS_WINDOW_DEFAULT, \
+   .lsh_ttl = SALF_LSH_TTL_DEFAULT, \
+   .clusters = SALF_CLUSTERS_DEFAULT, \
+}
+
+/*!
+ * \brief State of adaptive strategies.
+ */
+typedef struct salf_state_s {
+   double threshold; /*< Labeling threshold. */
+   double u; /*< Number of labeled flows. */
+   long t; /*< Number of seen flows. */
+   salf_window_t window; /*< Decisions of last params.window flows (budget check). */
+   double tokens; /*< Tokens of rate budget, HUGE_VAL if unlimited. */
+   uint64_t tokens_ts; /*< Time of last refill in ns. */
+   double share; /*< Fraction of rate budget of instance (instance decides this fraction of the stream). */
+   double offered; /*< Accumulator of throttle level, record is offered to strategy when it reaches 1. */
+   p2_t quantile; /*< Budget quantile of max probabilities (auto threshold). */
+   double rate; /*< Label rate averaged over SALF_PI_WINDOW flows (PI controller). */
+   double integral; /*< Integral term of PI controller. */
+   salf_strata_t strata; /*< Flows and labels per predicted class (stratified budget). */
+   salf_hold_t hold; /*< Records held in open window (windowed strategies). */
+   double reservoir_w; /*< Weight of Algorithm L (reservoir strategy). */
+   uint64_t reservoir_next; /*< Number of record of window which enters full reservoir next. */
+   salf_sketch_t sketch; /*< Labels per endpoint pair (dedup). */
+   salf_hosts_t hosts; /*< Labels per source host in current host window (host cap). */
+   salf_lsh_t lsh; /*< Signatures of features of labeled flows (near-duplicate suppression). */
+   salf_kmeans_t kmeans; /*< Clusters of features with label counts (diversity strategy). */
+   rng_t rng; /*< Random number generator. */
+} salf_state_t;
+
+/*!
+ * \brief Strategy instance.
+ * Instances are independent, any number of them can run in one process,
+ * but one instance must be used by one thread at a time.
+ */
+typedef struct salf_strategy_s {
+   salf_params_t params; /*< Parameters. */
+   salf_state_t state; /*< State. */
+   size_t out; /*< Output interface of records released by windowed strategies. */
+} salf_strategy_t;
+
+/*!
+ * \brief Set of strategy instances evaluated over one stream.
+ * Instance i selects records for output interface i.
+ */
+typedef struct salf_strategy_set_s {
+   salf_strategy_t *strategy; /*< Instances. */
+   size_t cnt; /*< Number of instances. */
+   unsigned int params_gen; /*< Generation of parameters applied to instances. */
+   struct salf_ckpt_rec_s *ckpt; /*< Records the state is saved to after every batch, NULL if not persistent. */
+} salf_strategy_set_t;
+
+/*!
+ * \brief Parse strategy configuration.
+ * Configuration is a comma separated list of key=value pairs, keys are
+ * q (query strategy), b (budget), t (threshold), s (step), d (deviation),
+ * r (rate in labels/s), R (burst), a (auto threshold, 0 or 1),
+ * g and G (proportional and integral gain), W (budget window),
+ * e (committee measure), y (stratification), k, n and i (records selected
+ * per window, records per window and window duration of windowed strategies),
+ * x and o (fields of flow key and one-way key), u and l (max labels per
+ * endpoint pair and its half-life), h and j (max label share of source host
+ * and labels per host window), L and T (bands of feature signature and
+ * its TTL), C (clusters of diversity strategy).
+ * Keys which are not present keep their value in params.
+ * \param[in,out] params Parameters.
+ * \param[in] spec Configuration, e.g. "q=2,b=0.05,s=0.2".
+ * \return 0 on success, 1 on parse error.
+ */
+int salf_params_parse(salf_params_t *params, const char *spec);
+
+/*!
+ * \brief Load strategy configurations from file.
+ * File contains one configuration per line in the format of salf_params_parse(),
+ * empty lines and lines starting with '#' are ignored. Configuration on line i
+ * overrides params[i], which has to be initialized by caller.
+ * \param[in] path File name.
+ * \param[in,out] params Parameters, one per configuration.
+ * \param[in] max Max number of configurations.
+ * \param[out] cnt Number of configurations in file.
+ * \return 0 on success, 1 on error (message is printed).
+ */
+int salf_params_load(const char *path, salf_params_t *params, size_t max, size_t *cnt);
+
+/*!
+ * \brief Check strategy configuration against fields given to the module.
+ * Called at start and on every reload, before the configuration is used.
+ * \param[in] params Parameters.
+ * \param[in] committee_cnt Number of probability arrays of committee members.
+ * \param[in] features_cnt Number of feature fields.
+ * \return 0 if valid, 1 otherwise (message is printed).
+ */
+int salf_params_validate(const salf_params_t *params, size_t committee_cnt, size_t features_cnt);
+
+/*!
+ * \brief Check strategy configuration against fields of input format.
+ * Called whenever the format changes (and on reload), fields used by the
+ * configuration are optional in the view.
+ * \param[in] params Parameters.
+ * \param[in] view View of records with resolved offsets.
+ * \return 0 if the format fits, 1 otherwise (message is printed).
+ */
+int salf_params_check_view(const salf_params_t *params, const salf_view_t *view);
+
+/*!
+ * \brief Resolve committee fields in template.
+ * \param[out] c Committee.
+ * \param[in] tmplt Template.
+ * \param[in] names Names of probability arrays of members.
+ * \param[in] cnt Number of members.
+ * \return NULL on success, name of missing field otherwise.
+ */
+const char *salf_committee_resolve(salf_committee_t *c, const ur_template_t *tmplt, const char **names, size_t cnt);
+
+/*!
+ * \brief Resolve feature fields in template.
+ * \param[out] f Features.
+ * \param[in] tmplt Template.
+ * \param[in] names Names of numeric fields.
+ * \param[in] cnt Number of fields.
+ * \return NULL on success, name of missing or non-numeric field otherwise.
+ */
+const char *salf_features_resolve(salf_features_t *f, const ur_template_t *tmplt, const char **names, size_t cnt);
+
+/*!
+ * \brief Initialize strategy instance.
+ * Unknown strategy ID falls back to Random Strategy.
+ * \param[out] s Instance.
+ * \param[in] params Parameters.
+ * \param[in] seed Seed of random number generator.
+ * \param[in] stream Unique number of instance, instances with the same seed and different stream draw independent numbers.
+ */
+void salf_strategy_init(salf_strategy_t *s, const salf_params_t *params, uint64_t seed, uint64_t stream);
+
+/*!
+ * \brief Refill token bucket of rate budget.
+ * Called once per batch, every selected record then takes one token and
+ * records are not offered to the strategy while the bucket is empty. The
+ * bucket of instance holds at least one token, otherwise a low rate (or its
+ * share of one of many workers) would never label anything.
+ * \param[in,out] s Instance.
+ * \param[in] ts Time in ns.
+ */
+static inline void salf_tokens_refill(salf_strategy_t *s, uint64_t ts)
+{
+   salf_state_t *state = &s->state;
+   double rate = s->params.rate * state->share;
+   double burst = (s->params.burst > 0 ? s->params.burst : s->params.rate) * state->share;
+
+   if (burst < 1.0) {
+      burst = 1.0;
+   }
+   if (rate <= 0) {
+      state->tokens = HUGE_VAL;
+   } else {
+      if (ts > state->tokens_ts) {
+         state->tokens += rate * (double)(ts - state->tokens_ts) / NS;
+      }
+      if (state->tokens > burst) {
+         state->tokens = burst;
+      }
+   }
+   state->tokens_ts = ts;
+}
+
+/*!
+ * \brief Check whether record is offered to strategy under backpressure.
+ * The accumulator grows by throttle per record and a record is offered when
+ * it reaches 1. It is clamped to 1, so records skipped for other reasons
+ * (empty token bucket) do not bank offers for later.
+ * \param[in,out] s Instance.
+ * \param[in] throttle Fraction of offered records, 0 .. 1.
+ * \return Nonzero if record is offered.
+ */
+static inline int salf_strategy_offer(salf_strategy_t *s, double throttle)
+{
+   salf_state_t *state = &s->state;
+
+   state->offered += throttle;
+   if (state->offered > 1.0) {
+      state->offered = 1.0;
+   }
+   if (state->offered < 1.0) {
+      return 0;
+   }
+   state->offered -= 1.0;
+   return 1;
+}
+
+/*!
+ * \brief Check whether strategy decides on windows of records.
+ * Windowed strategies hold records until their window closes and release
+ * the selected ones with a later batch.
+ * \param[in] query_strategy Strategy ID.
+ * \return Nonzero for windowed strategy.
+ */
+static inline int salf_strategy_windowed(int query_strategy)
+{
+   return query_strategy == SALF_Q_TOPK || query_strategy == SALF_Q_RESERVOIR;
+}
+
+/*!
+ * \brief Check whether any of parameters selects windowed strategy.
+ * \param[in] params Parameters.
+ * \param[in] cnt Number of parameters.
+ * \return Nonzero if some strategy is windowed.
+ */
+static inline int salf_params_windowed(const salf_params_t *params, size_t cnt)
+{
+   size_t i;
+
+   for (i = 0; i < cnt; i++) {
+      if (salf_strategy_windowed(params[i].query_strategy)) {
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/*!
+ * \brief Run strategy over all records in batch.
+ * Strategy is selected once per batch, the loop over records is compiled
+ * separately for every strategy with the decision function inlined.
+ * \param[in,out] s Instance.
+ * \param[in] batch Batch, batch->maxp caches max probabilities.
+ * \param[out] decision Decisions, one per record.
+ * \return Number of selected records.
+ */
+size_t salf_strategy_batch(salf_strategy_t *s, salf_batch_t *batch, char *decision);
+
+/*!
+ * \brief Allocate set of instances.
+ * \param[out] set Set.
+ * \param[in] params Parameters, one per instance.
+ * \param[in] cnt Number of instances.
+ * \param[in] seed Seed of random number generator.
+ * \param[in] stream First stream number, instance i uses stream + i.
+ * \return 0 on success, 1 on allocation failure.
+ */
+int salf_strategy_set_init(salf_strategy_set_t *set, const salf_params_t *params, size_t cnt, uint64_t seed, uint64_t stream);
+
+/*!
+ * \brief Set fraction of rate budget of all instances.
+ * \param[in,out] set Set.
+ * \param[in] share Fraction, e.g. 1/N for one of N workers.
+ */
+void salf_strategy_set_share(salf_strategy_set_t *set, double share);
+
+/*!
+ * \brief Free set of instances.
+ * \param[in] set Set.
+ */
+void salf_strategy_set_free(salf_strategy_set_t *set);
+
+/*!
+ * \brief Replace parameters of all instances.
+ * State of instances (threshold, budget counters) is kept. Instance that
+ * leaves a windowed strategy closes its window first, so the held records
+ * are released with the batch.
+ * \param[in,out] set Set.
+ * \param[in] params Parameters, one per instance.
+ * \param[in,out] batch Batch the held records are released with.
+ * \return Number of released records.
+ */
+size_t salf_strategy_set_update(salf_strategy_set_t *set, const salf_params_t *params, salf_batch_t *batch);
+
+/*!
+ * \brief Run all instances of set over batch.
+ * Max probability of every record is computed at most once and shared by
+ * all instances. Decisions of instance k are stored at batch->decision + k * batch->cap.
+ * If the batch carries newer parameters than the set, they are applied first.
+ * \param[in,out] set Set.
+ * \param[in] batch Batch.
+ * \return Number of selections of all instances.
+ */
+size_t salf_strategy_set_batch(salf_strategy_set_t *set, salf_batch_t *batch);
+
+/*!
+ * \brief Max of probabilities in record.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \return Max probability, 0 for empty array.
+ */
+static inline double get_max(const void *data, const salf_view_t *view)
+{
+   uint16_t size;
+   const double *probas = salf_view_PREDICTED_PROBAS(view, data, &size);
+   if (size == 0) {
+      return 0;
+   }
+   return probas_max(probas, size);
+}
+
+/*!
+ * \brief Max of probabilities in record, computed once per record.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max, negative if not computed yet.
+ * \return Max probability, 0 for empty array.
+ */
+static inline double get_max_cached(const void *data, const salf_view_t *view, double *maxp)
+{
+   if (*maxp < 0) {
+      *maxp = get_max(data, view);
+   }
+   return *maxp;
+}
+
+/*!
+ * \brief Predicted class of record, the first index of max probability.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record.
+ * \return Class id, clamped to SALF_STRATA_MAX - 1.
+ */
+static inline size_t get_class(const void *data, const salf_view_t *view, double *maxp)
+{
+   uint16_t size;
+   const double *probas = salf_view_PREDICTED_PROBAS(view, data, &size);
+   double max = get_max_cached(data, view, maxp);
+   size_t c = 0;
+
+   while (c + 1 < size && c < SALF_STRATA_MAX - 1 && !(probas_at(probas, c) == max)) {
+      c++;
+   }
+   return c;
+}
+
+/*!
+ * \brief Read feature vector of record.
+ * Values are converted to float with compressed dynamic range (fvec_log2()).
+ * \param[in] data Pointer to data.
+ * \param[in] f Features with resolved offsets.
+ * \param[out] x Feature vector of f->cnt elements.
+ */
+static inline void salf_features_read(const void *data, const salf_features_t *f, float *x)
+{
+   size_t i;
+
+   for (i = 0; i < f->cnt; i++) {
+      const char *p = (const char *)data + f->offset[i];
+      double v;
+      switch (f->type[i]) {
+      case UR_TYPE_UINT8:
+         v = *(const uint8_t *)p;
+         break;
+      case UR_TYPE_INT8:
+         v = *(const int8_t *)p;
+         break;
+      case UR_TYPE_UINT16: {
+         uint16_t u;
+         memcpy(&u, p, sizeof(u));
+         v = u;
+         break;
+      }
+      case UR_TYPE_INT16: {
+         int16_t u;
+         memcpy(&u, p, sizeof(u));
+         v = u;
+         break;
+      }
+      case UR_TYPE_UINT32: {
+         uint32_t u;
+         memcpy(&u, p, sizeof(u));
+         v = u;
+         break;
+      }
+      case UR_TYPE_INT32: {
+         int32_t u;
+         memcpy(&u, p, sizeof(u));
+         v = u;
+         break;
+      }
+      case UR_TYPE_UINT64: {
+         uint64_t u;
+         memcpy(&u, p, sizeof(u));
+         v = (double)u;
+         break;
+      }
+      case UR_TYPE_INT64: {
+         int64_t u;
+         memcpy(&u, p, sizeof(u));
+         v = (double)u;
+         break;
+      }
+      case UR_TYPE_FLOAT: {
+         float u;
+         memcpy(&u, p, sizeof(u));
+         v = u;
+         break;
+      }
+      default: {
+         memcpy(&v, p, sizeof(v));
+         break;
+      }
+      }
+      x[i] = fvec_log2(v);
+   }
+}
+
+/*!
+ * \brief Count flow which is not offered to strategy as not labeled.
+ * Budget of strategy is then checked over all flows, so labels of classes
+ * over quota are left to the other classes.
+ * \param[in,out] s Strategy instance.
+ */
+static inline void salf_strategy_skip(salf_strategy_t *s)
+{
+   salf_state_t *state = &s->state;
+   state->t++;
+   salf_window_push(&state->window, 0);
+   state->rate -= state->rate * (1.0 / SALF_PI_WINDOW);
+}
+
+/*!
+ * \brief Random Strategy function (ID 0)
+ * Function to ...
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char random_strategy(salf_strategy_t *s,const void *data,const salf_view_t *view,double *maxp){
+   (void)data;
+   (void)view;
+   (void)maxp;
+   return (rng_uniform(&s->state.rng) < s->params.budget);
+}
+
+/*!
+ * \brief  Fixed Uncertainty Strategy (ID 1)
+ * Function to ...
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char fixed_uncertainty_strategy(salf_strategy_t *s,const void *data,const salf_view_t *view,double *maxp){
+   double probability = get_max_cached(data,view,maxp);
+   if(s->params.auto_threshold){
+      // threshold follows budget quantile, so the label rate stays at budget
+      p2_add(&s->state.quantile, probability);
+      s->state.threshold = p2_get(&s->state.quantile, s->params.labeling_threshold);
+      return(probability < s->state.threshold);
+   }
+   return(probability < s->params.labeling_threshold);
+}
+
+/*!
+ * \brief Margin of record, top-1 minus top-2 probability.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record (unused).
+ * \return Margin, 0 for empty array.
+ */
+static inline double get_margin(const void *data, const salf_view_t *view, double *maxp)
+{
+   uint16_t size;
+   const double *probas = salf_view_PREDICTED_PROBAS(view, data, &size);
+   (void)maxp;
+   return probas_margin(probas, size);
+}
+
+/*!
+ * \brief Certainty of record, 1 - entropy / ln(number of classes).
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record (unused).
+ * \return Certainty in [0,1], 1 for arrays with less than two elements.
+ */
+static inline double get_certainty(const void *data, const salf_view_t *view, double *maxp)
+{
+   uint16_t size;
+   const double *probas = salf_view_PREDICTED_PROBAS(view, data, &size);
+   (void)maxp;
+   if (size < 2) {
+      return 1;
+   }
+   return 1 - probas_entropy(probas, size) / probas_log(size);
+}
+
+/*!
+ * \brief Certainty score of record, flows with score under threshold are uncertain.
+ */
+typedef double (*salf_score_fnc_t)(const void *data, const salf_view_t *view, double *maxp);
+
+/*!
+ * \brief Decide by score and adapt threshold of variable uncertainty.
+ * \param[in,out] s Strategy instance.
+ * \param[in] probability Certainty score of record.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char salf_variable_decide(salf_strategy_t *s, double probability){
+   salf_state_t *state = &s->state;
+   if(probability < state->threshold){
+      state->u++;
+      state->threshold *= 1 - s->params.step;
+      return 1;
+   }
+   state->threshold *= s->params.step + 1;
+   return 0;
+}
+
+/*!
+ * \brief Variable uncertainty over given score.
+ * Score is computed only when the budget allows labeling, score function
+ * is a constant at every call site, so it is inlined.
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record.
+ * \param[in] score Score function.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char salf_variable_uncertainty(salf_strategy_t *s,const void *data,const salf_view_t *view,double *maxp,salf_score_fnc_t score){
+   salf_state_t *state = &s->state;
+   char label = 0;
+   state->t++;
+
+   if(salf_window_below(&state->window, s->params.budget)){
+      label = salf_variable_decide(s, score(data,view,maxp));
+   }
+   salf_window_push(&state->window, label);
+   return label;
+}
+
+/*!
+ * \brief Variable Uncertainty Strategy (ID 2)
+ * Function to ...
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char variable_uncertainty_strategy(salf_strategy_t *s,const void *data,const salf_view_t *view,double *maxp){
+   return salf_variable_uncertainty(s,data,view,maxp,get_max_cached);
+}
+
+/*!
+ * \brief Margin Uncertainty Strategy (ID 5)
+ * Variable Uncertainty Strategy with margin between the two most probable
+ * classes instead of max probability.
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char margin_uncertainty_strategy(salf_strategy_t *s,const void *data,const salf_view_t *view,double *maxp){
+   return salf_variable_uncertainty(s,data,view,maxp,get_margin);
+}
+
+/*!
+ * \brief Entropy Uncertainty Strategy (ID 6)
+ * Variable Uncertainty Strategy with certainty 1 - H / ln(n), where H is
+ * Shannon entropy of the n predicted probabilities, instead of max probability.
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char entropy_uncertainty_strategy(salf_strategy_t *s,const void *data,const salf_view_t *view,double *maxp){
+   return salf_variable_uncertainty(s,data,view,maxp,get_certainty);
+}
+
+/*!
+ * \brief Certainty of committee, 1 - normalized disagreement of members.
+ * Vote entropy counts votes for the most probable class of every member and
+ * is normalized by ln(min(members, classes)). Mean KL divergence of members
+ * from their mean distribution equals H(mean) - mean(H(member)) and is
+ * normalized by ln(members). Members are compared over the classes present
+ * in all of them.
+ * \param[in] data Pointer to data.
+ * \param[in] c Committee with resolved offsets.
+ * \param[in] measure SALF_COMMITTEE_VOTE or SALF_COMMITTEE_KL.
+ * \return Certainty in [0,1], 1 if there is nothing to disagree on.
+ */
+static inline double get_committee_certainty(const void *data, const salf_committee_t *c, int measure)
+{
+   const double *p[SALF_COMMITTEE_MAX];
+   size_t m, j;
+   size_t n = SALF_COMMITTEE_CLASSES;
+   uint16_t size;
+
+   for (m = 0; m < c->cnt; m++) {
+      p[m] = ur_view_array(data, c->static_size, c->offset[m], &size);
+      if (size / sizeof(double) < n) {
+         n = size / sizeof(double);
+      }
+   }
+   if (c->cnt < 2 || n < 2) {
+      return 1;
+   }
+
+   if (measure == SALF_COMMITTEE_KL) {
+      static __thread double mean[SALF_COMMITTEE_CLASSES];
+      double h = 0;
+      double scale = 1.0 / (double)c->cnt;
+      for (m = 0; m < c->cnt; m++) {
+         const double *pm = p[m];
+         h += probas_entropy(pm, n);
+         if (m == 0) {
+            for (j = 0; j < n; j++) {
+               mean[j] = probas_at(pm, j) * scale;
+            }
+         } else {
+            for (j = 0; j < n; j++) {
+               mean[j] += probas_at(pm, j) * scale;
+            }
+         }
+      }
+      return 1 - (probas_entropy(mean, n) - h * scale) / probas_log((double)c->cnt);
+   } else {
+      size_t vote[SALF_COMMITTEE_MAX];
+      size_t cnt[SALF_COMMITTEE_MAX];
+      size_t classes = 0;
+      double h = 0;
+      for (m = 0; m < c->cnt; m++) {
+         // first most probable class
+         double max = probas_max(p[m], n);
+         size_t arg = 0;
+         while (arg < n - 1 && !(probas_at(p[m], arg) == max)) {
+            arg++;
+         }
+         for (j = 0; j < classes && vote[j] != arg; j++) {
+         }
+         if (j == classes) {
+            vote[classes] = arg;
+            cnt[classes++] = 0;
+         }
+         cnt[j]++;
+      }
+      if (classes == 1) {
+         return 1;
+      }
+      for (j = 0; j < classes; j++) {
+         double f = (double)cnt[j] / (double)c->cnt;
+         h -= f * probas_log(f);
+      }
+      return 1 - h / probas_log((double)(c->cnt < n ? c->cnt : n));
+   }
+}
+
+/*!
+ * \brief Committee Uncertainty Strategy (ID 7)
+ * Variable Uncertainty Strategy with certainty of committee of models
+ * (get_committee_certainty()) instead of max probability.
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] c Committee with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record (unused).
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char committee_uncertainty_strategy(salf_strategy_t *s,const void *data,const salf_committee_t *c,double *maxp){
+   salf_state_t *state = &s->state;
+   char label = 0;
+   (void)maxp;
+   state->t++;
+
+   if(salf_window_below(&state->window, s->params.budget)){
+      label = salf_variable_decide(s, get_committee_certainty(data, c, s->params.committee_measure));
+   }
+   salf_window_push(&state->window, label);
+   return label;
+}
+
+/*!
+ * \brief Uncertainty Strategy with Randomization (ID 3)
+ * Function to ...
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char uncertainty_strategy_with_randomization(salf_strategy_t *s,const void *data,const salf_view_t *view,double *maxp){
+   salf_state_t *state = &s->state;
+   char label = 0;
+   state->t++;
+
+   if(salf_window_below(&state->window, s->params.budget)){
+      double probability = get_max_cached(data,view,maxp);
+      if(probability < (state->threshold * rng_normal(&state->rng,1,s->params.t_deviation))){
+         state->u++;
+         state->threshold *= 1 - s->params.step;
+         label = 1;
+      }else{
+         state->threshold *= s->params.step + 1;
+      }
+   }
+   salf_window_push(&state->window, label);
+   return label;
+}
+
+/*!
+ * \brief Clamp value to interval [0,1].
+ */
+static inline double salf_clamp01(double x)
+{
+   return x < 0 ? 0 : (x > 1 ? 1 : x);
+}
+
+/*!
+ * \brief Uncertainty Strategy with PI Controller (ID 4)
+ * Threshold is the output of PI controller driven by relative error of the
+ * label rate, which is averaged over last SALF_PI_WINDOW flows. The integral
+ * term is clamped to [0,1] (anti-windup) and no flow is labeled while the
+ * rate exceeds the budget by SALF_PI_OVERSHOOT, which bounds the overshoot.
+ * The same bound is checked over the whole budget window. It is not the
+ * budget itself, otherwise the window check would limit labels instead of
+ * the controller and the integral term would wind up.
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char pi_uncertainty_strategy(salf_strategy_t *s,const void *data,const salf_view_t *view,double *maxp){
+   salf_state_t *state = &s->state;
+   double budget = s->params.budget;
+   double err = budget > 0 ? (budget - state->rate) / budget : -1;
+   char label = 0;
+
+   state->t++;
+   state->integral = salf_clamp01(state->integral + s->params.ki * err);
+   state->threshold = salf_clamp01(state->integral + s->params.kp * err);
+   if(state->rate < budget * SALF_PI_OVERSHOOT && salf_window_below(&state->window, budget * SALF_PI_OVERSHOOT)){
+      double probability = get_max_cached(data,view,maxp);
+      label = probability < state->threshold;
+   }
+   salf_window_push(&state->window, label);
+   state->u += label;
+   state->rate += ((double)label - state->rate) * (1.0 / SALF_PI_WINDOW);
+   return label;
+}
+
+/*!
+ * \brief Flow Hash Strategy (ID 10)
+ * Flow is labeled if hash of its flow key maps below budget, so every
+ * record of a flow (both directions of a session, repeated exports of a long
+ * flow) gets the same decision, and records are labeled with probability
+ * budget without any random number. Flow selected at some budget is
+ * selected at every higher budget.
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] view View of record with resolved offsets.
+ * \param[in,out] maxp Cached max probability of record (unused).
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char flow_hash_strategy(salf_strategy_t *s,const void *data,const salf_view_t *view,double *maxp){
+   uint64_t h = salf_flowhash(data, view, s->params.hash_key, s->params.hash_oneway);
+   char label = (double)(h >> 11) * 0x1.0p-53 < s->params.budget;
+   (void)maxp;
+   s->state.t++;
+   s->state.u += label;
+   return label;
+}
+
+/*!
+ * \brief Diversity Strategy (ID 11)
+ * Variable Uncertainty Strategy over 1 - (1 - max probability) * w, where
+ * w is the diversity weight of the flow (salf_kmeans_diversity()): uncertain
+ * flows of clusters with few labels are preferred to equally uncertain flows
+ * of well labeled clusters, near duplicates of a centroid the least. Without
+ * feature fields every weight is 1, i.e. it is Variable Uncertainty Strategy.
+ * \param[in,out] s Strategy instance.
+ * \param[in] data Pointer to data.
+ * \param[in] batch Batch of record (view and feature fields).
+ * \param[in,out] maxp Cached max probability of record.
+ * \return {true,false} indicates whether to request the true label.
+ */
+static inline char diversity_strategy(salf_strategy_t *s,const void *data,const salf_batch_t *batch,double *maxp){
+   salf_state_t *state = &s->state;
+   size_t j = SALF_CLUSTERS_MAX;
+   float d = 0;
+   char label = 0;
+   state->t++;
+
+   if(state->kmeans.c != NULL && batch->features.cnt > 0){
+      float x[SALF_FEATURES_MAX];
+      salf_features_read(data, &batch->features, x);
+      j = salf_kmeans_assign(&state->kmeans, x, batch->features.cnt, s->params.clusters, &d);
+   }
+   if(salf_window_below(&state->window, s->params.budget)){
+      double w = salf_kmeans_diversity(&state->kmeans, j, d);
+      label = salf_variable_decide(s, 1 - (1 - get_max_cached(data, &batch->view, maxp)) * w);
+      if(label){
+         salf_kmeans_label(&state->kmeans, j);
+      }
+   }
+   salf_window_push(&state->window, label);
+   return label;
+}
+
+#endif /* _STRATEGY_H_ */
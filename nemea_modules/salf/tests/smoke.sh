@@ -0,0 +1,10 @@
+#!/bin/sh
+# Smoke test of built binaries: both link and start (help exits with 0).
+set -e
+
+./salf -h > /dev/null 2>&1
+./salf_replay -h > /dev/null 2>&1
+if ./salf_replay > /dev/null 2>&1; then
+   echo "salf_replay without input files did not fail" >&2
+   exit 1
+fi
@@ -0,0 +1,242 @@
+/*!
+ * \file test.h
+ * \brief Helpers of SALF unit tests
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "strategy.h"
+
+/*
+ * Tests are plain programs run by make check, every failed check prints its
+ * location and the program exits with nonzero status. Strategies are fed
+ * batches of synthetic records built here, so no template (and no libtrap
+ * interface) is needed.
+ */
+
+#define TEST_CLASSES 4 /*< Number of classes of synthetic records. */
+#define TEST_BATCH 256 /*< Max number of records in test batch. */
+
+static int test_failed = 0; /*< Number of failed checks. */
+
+/*!
+ * \brief Check condition, print message and count failure if it does not hold.
+ */
+#define CHECK(COND, ...) \
+   do { \
+      if (!(COND)) { \
+         fprintf(stderr, "%s:%d: check failed: %s: ", __FILE__, __LINE__, #COND); \
+         fprintf(stderr, __VA_ARGS__); \
+         fprintf(stderr, "\n"); \
+         test_failed++; \
+      } \
+   } while (0)
+
+/*!
+ * \brief Exit status of test program.
+ */
+#define TEST_RESULT() (test_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
+
+/*!
+ * \brief Synthetic flow record.
+ * Static part with flow key and features, followed by two probability
+ * arrays (prediction and second committee member).
+ */
+typedef struct test_rec_s {
+   ip_addr_t src_ip; /*< SRC_IP. */
+   ip_addr_t dst_ip; /*< DST_IP. */
+   uint16_t src_port; /*< SRC_PORT. */
+   uint16_t dst_port; /*< DST_PORT. */
+   uint8_t protocol; /*< PROTOCOL. */
+   uint8_t pad[3]; /*< Padding. */
+   uint64_t bytes; /*< Feature of type uint64. */
+   uint32_t packets; /*< Feature of type uint32. */
+   uint32_t pad2; /*< Padding. */
+   double duration; /*< Feature of type double. */
+   uint16_t probas[2]; /*< Header of PREDICTED_PROBAS (offset, length). */
+   uint16_t member[2]; /*< Header of probabilities of committee member (offset, length). */
+   double p[TEST_CLASSES]; /*< PREDICTED_PROBAS. */
+   double q[TEST_CLASSES]; /*< Probabilities of committee member. */
+} test_rec_t;
+
+/*!
+ * \brief Batch of synthetic records with its storage.
+ */
+typedef struct test_batch_s {
+   salf_batch_t batch; /*< Batch passed to strategies. */
+   test_rec_t rec[TEST_BATCH]; /*< Records. */
+   const void *ptr[TEST_BATCH]; /*< Pointers to records. */
+   uint16_t size[TEST_BATCH]; /*< Sizes of records. */
+   double maxp[TEST_BATCH]; /*< Cached max probabilities. */
+   char *decision; /*< Decisions, TEST_BATCH per strategy. */
+} test_batch_t;
+
+/*!
+ * \brief Initialize batch of synthetic records, all fields are present.
+ * \param[out] tb Batch.
+ * \param[in] nout Number of strategy instances.
+ * \return 0 on success, 1 on allocation failure.
+ */
+static inline int test_batch_init(test_batch_t *tb, size_t nout)
+{
+   salf_batch_t *b = &tb->batch;
+   size_t i;
+
+   memset(tb, 0, sizeof(*tb));
+   tb->decision = calloc(nout * TEST_BATCH, 1);
+   if (tb->decision == NULL) {
+      return 1;
+   }
+   for (i = 0; i < TEST_BATCH; i++) {
+      tb->ptr[i] = &tb->rec[i];
+      tb->size[i] = sizeof(tb->rec[i]);
+   }
+   b->rec = tb->ptr;
+   b->size = tb->size;
+   b->maxp = tb->maxp;
+   b->decision = tb->decision;
+   b->nout = nout;
+   b->cap = TEST_BATCH;
+   b->throttle = 1.0;
+   b->view.static_size = offsetof(test_rec_t, p);
+   b->view.PREDICTED_PROBAS = offsetof(test_rec_t, probas);
+   b->view.SRC_IP = offsetof(test_rec_t, src_ip);
+   b->view.DST_IP = offsetof(test_rec_t, dst_ip);
+   b->view.SRC_PORT = offsetof(test_rec_t, src_port);
+   b->view.DST_PORT = offsetof(test_rec_t, dst_port);
+   b->view.PROTOCOL = offsetof(test_rec_t, protocol);
+   b->committee.static_size = offsetof(test_rec_t, p);
+   b->committee.cnt = 2;
+   b->committee.offset[0] = offsetof(test_rec_t, probas);
+   b->committee.offset[1] = offsetof(test_rec_t, member);
+   b->features.cnt = 3;
+   b->features.offset[0] = offsetof(test_rec_t, bytes);
+   b->features.type[0] = UR_TYPE_UINT64;
+   b->features.offset[1] = offsetof(test_rec_t, packets);
+   b->features.type[1] = UR_TYPE_UINT32;
+   b->features.offset[2] = offsetof(test_rec_t, duration);
+   b->features.type[2] = UR_TYPE_DOUBLE;
+   return 0;
+}
+
+/*!
+ * \brief Free batch.
+ * \param[in,out] tb Batch.
+ */
+static inline void test_batch_free(test_batch_t *tb)
+{
+   salf_release_free(&tb->batch.release);
+   free(tb->decision);
+   tb->decision = NULL;
+}
+
+/*!
+ * \brief Fill probability array with random distribution over classes.
+ * \param[in,out] rng Generator.
+ * \param[out] p Array of TEST_CLASSES probabilities.
+ */
+static inline void test_probas_random(rng_t *rng, double *p)
+{
+   double sum = 0;
+   size_t c;
+
+   for (c = 0; c < TEST_CLASSES; c++) {
+      p[c] = rng_uniform(rng);
+      p[c] *= p[c] * p[c];
+      sum += p[c];
+   }
+   for (c = 0; c < TEST_CLASSES; c++) {
+      p[c] /= sum;
+   }
+}
+
+/*!
+ * \brief Fill record with random flow of one of flows endpoint pairs.
+ * \param[in,out] rng Generator.
+ * \param[out] r Record.
+ * \param[in] flows Number of distinct flow keys.
+ */
+static inline void test_rec_random(rng_t *rng, test_rec_t *r, uint64_t flows)
+{
+   uint64_t flow = rng_below(rng, flows);
+
+   memset(r, 0, sizeof(*r));
+   r->src_ip.ui64[1] = 0x0a000000 + (flow >> 8);
+   r->dst_ip.ui64[1] = 0xc0a80000 + (flow & 0xff);
+   r->src_port = (uint16_t)(1024 + flow % 50000);
+   r->dst_port = (uint16_t)(flow % 3 == 0 ? 443 : 53);
+   r->protocol = flow % 3 == 0 ? 6 : 17;
+   r->bytes = 40 + rng_below(rng, 1u << 20);
+   r->packets = 1 + (uint32_t)rng_below(rng, 1000);
+   r->duration = rng_uniform(rng) * 60;
+   r->probas[0] = 0;
+   r->probas[1] = TEST_CLASSES * sizeof(double);
+   r->member[0] = TEST_CLASSES * sizeof(double);
+   r->member[1] = TEST_CLASSES * sizeof(double);
+   test_probas_random(rng, r->p);
+   test_probas_random(rng, r->q);
+}
+
+/*!
+ * \brief Fill batch with random records.
+ * \param[in,out] tb Batch.
+ * \param[in,out] rng Generator.
+ * \param[in] cnt Number of records, at most TEST_BATCH.
+ * \param[in] flows Number of distinct flow keys.
+ * \param[in] ts Time of batch in ns.
+ */
+static inline void test_batch_fill(test_batch_t *tb, rng_t *rng, size_t cnt, uint64_t flows, uint64_t ts)
+{
+   size_t i;
+
+   for (i = 0; i < cnt; i++) {
+      test_rec_random(rng, &tb->rec[i], flows);
+   }
+   salf_release_clear(&tb->batch.release);
+   tb->batch.cnt = cnt;
+   tb->batch.ts = ts;
+}
+
+#endif /* _TEST_H_ */
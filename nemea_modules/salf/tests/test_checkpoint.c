@@ -0,0 +1,215 @@
+/*!
+ * \file test_checkpoint.c
+ * \brief Unit tests of persistent strategy state
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "test.h"
+#include "checkpoint.h"
+#include <unistd.h>
+#include <fcntl.h>
+
+/*!
+ * \brief Run strategies of set over synthetic batches.
+ * \param[in,out] set Set.
+ * \param[in,out] tb Batch.
+ * \param[in] batches Number of batches.
+ */
+static void ckpt_run(salf_strategy_set_t *set, test_batch_t *tb, size_t batches)
+{
+   rng_t rng;
+   size_t i;
+
+   rng_seed(&rng, 3, 0);
+   for (i = 0; i < batches; i++) {
+      test_batch_fill(tb, &rng, TEST_BATCH, 1000000, i * 1000000ULL);
+      salf_strategy_set_batch(set, &tb->batch);
+   }
+}
+
+/*!
+ * \brief Write state file of layout version 1.
+ * Layout 1 records differ by padding in place of rate and integral, which
+ * is filled with garbage here to check that it is ignored.
+ * \param[in] path File name.
+ * \param[in] rec Records, nout per shard.
+ * \param[in] shards Number of shards.
+ * \param[in] nout Number of instances per shard.
+ * \return 0 on success.
+ */
+static int ckpt_write_v1(const char *path, const salf_ckpt_rec_t *rec, size_t shards, size_t nout)
+{
+   salf_ckpt_hdr_t hdr;
+   salf_ckpt_rec_t r;
+   size_t i;
+   int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+   if (fd < 0) {
+      return 1;
+   }
+   memset(&hdr, 0, sizeof(hdr));
+   hdr.magic = SALF_CKPT_MAGIC;
+   hdr.version = 1;
+   hdr.nout = (uint32_t)nout;
+   hdr.shards = (uint32_t)shards;
+   if (write(fd, &hdr, sizeof(hdr)) != (ssize_t)sizeof(hdr)) {
+      close(fd);
+      return 1;
+   }
+   for (i = 0; i < shards * nout; i++) {
+      r = rec[i];
+      memset(&r.rate, 0xa5, sizeof(r.rate));
+      memset(&r.integral, 0xa5, sizeof(r.integral));
+      if (write(fd, &r, sizeof(r)) != (ssize_t)sizeof(r)) {
+         close(fd);
+         return 1;
+      }
+   }
+   return close(fd);
+}
+
+int main(int argc, char **argv)
+{
+   char path[] = "/tmp/salf_ckpt_XXXXXX";
+   salf_params_t params[2] = {SALF_PARAMS_DEFAULT, SALF_PARAMS_DEFAULT};
+   salf_strategy_set_t set, restored;
+   salf_ckpt_rec_t saved[2];
+   salf_ckpt_rec_t v1[4];
+   salf_ckpt_t ckpt;
+   test_batch_t *tb = malloc(sizeof(*tb));
+   int fd;
+   size_t k;
+
+   (void)argc;
+   (void)argv;
+   probas_init();
+   fvec_init();
+   rng_init();
+   fd = mkstemp(path);
+   if (tb == NULL || test_batch_init(tb, 2) || fd < 0) {
+      fprintf(stderr, "Error: test setup failed.\n");
+      return EXIT_FAILURE;
+   }
+   close(fd);
+   params[0].query_strategy = SALF_Q_VARIABLE;
+   params[0].budget = 0.05;
+   params[1].query_strategy = SALF_Q_PI;
+   params[1].budget = 0.05;
+
+   // state saved after every batch is restored by the same configuration
+   CHECK(salf_ckpt_open(&ckpt, path, 1, 2) == 0, "open %s", path);
+   CHECK(ckpt.old == NULL, "empty file has state");
+   salf_strategy_set_init(&set, params, 2, 1, 0);
+   salf_ckpt_attach(&ckpt, &set, 0);
+   ckpt_run(&set, tb, 100);
+   memcpy(saved, ckpt.rec, sizeof(saved));
+   salf_ckpt_close(&ckpt);
+   for (k = 0; k < 2; k++) {
+      CHECK(saved[k].valid && saved[k].t == set.strategy[k].state.t, "instance %zu saved t %ld", k, (long)saved[k].t);
+   }
+
+   CHECK(salf_ckpt_open(&ckpt, path, 1, 2) == 0, "reopen %s", path);
+   CHECK(ckpt.old != NULL, "saved state not found");
+   salf_strategy_set_init(&restored, params, 2, 1, 0);
+   CHECK(salf_ckpt_attach(&ckpt, &restored, 0) == 2, "not all instances restored");
+   for (k = 0; k < 2; k++) {
+      salf_state_t *a = &set.strategy[k].state;
+      salf_state_t *b = &restored.strategy[k].state;
+      CHECK(a->threshold == b->threshold && a->u == b->u && a->t == b->t, "instance %zu threshold %f/%f u %f/%f", k, a->threshold, b->threshold, a->u, b->u);
+      CHECK(a->rate == b->rate && a->integral == b->integral, "instance %zu PI state %f/%f", k, a->rate, b->rate);
+   }
+   salf_ckpt_close(&ckpt);
+   salf_strategy_set_free(&restored);
+
+   // counters of one shard are split among two
+   CHECK(salf_ckpt_open(&ckpt, path, 2, 2) == 0, "reopen %s with 2 shards", path);
+   CHECK(ckpt.old != NULL && ckpt.old_shards == 1, "state of 1 shard not found");
+   salf_strategy_set_init(&restored, params, 2, 1, 0);
+   CHECK(salf_ckpt_attach(&ckpt, &restored, 1) == 2, "not all instances restored");
+   for (k = 0; k < 2; k++) {
+      salf_state_t *b = &restored.strategy[k].state;
+      CHECK(b->threshold == saved[k].threshold, "instance %zu threshold %f/%f", k, b->threshold, saved[k].threshold);
+      CHECK(b->t == saved[k].t / 2, "instance %zu t %ld, saved %ld", k, (long)b->t, (long)saved[k].t);
+   }
+   salf_ckpt_close(&ckpt);
+   salf_strategy_set_free(&restored);
+
+   // state of other strategy is ignored
+   params[0].query_strategy = SALF_Q_MARGIN;
+   CHECK(salf_ckpt_open(&ckpt, path, 1, 2) == 0, "reopen %s", path);
+   salf_strategy_set_init(&restored, params, 2, 1, 0);
+   CHECK(salf_ckpt_attach(&ckpt, &restored, 0) == 1, "state of other strategy restored");
+   CHECK(restored.strategy[0].state.t == 0, "state of other strategy restored");
+   salf_ckpt_close(&ckpt);
+   salf_strategy_set_free(&restored);
+   params[0].query_strategy = SALF_Q_VARIABLE;
+
+   // layout 1 of two shards is merged with PI controller state reset
+   for (k = 0; k < 4; k++) {
+      v1[k] = saved[k % 2];
+   }
+   CHECK(ckpt_write_v1(path, v1, 2, 2) == 0, "write %s", path);
+   CHECK(salf_ckpt_open(&ckpt, path, 1, 2) == 0, "open layout 1");
+   CHECK(ckpt.old != NULL && ckpt.old_shards == 2, "layout 1 not read");
+   salf_strategy_set_init(&restored, params, 2, 1, 0);
+   CHECK(salf_ckpt_attach(&ckpt, &restored, 0) == 2, "layout 1 not restored");
+   for (k = 0; k < 2; k++) {
+      salf_state_t *b = &restored.strategy[k].state;
+      CHECK(b->threshold == saved[k].threshold, "instance %zu threshold %f/%f", k, b->threshold, saved[k].threshold);
+      CHECK(b->t == 2 * saved[k].t, "instance %zu t %ld, saved %ld", k, (long)b->t, (long)saved[k].t);
+      CHECK(b->rate == 0 && b->integral == 0, "instance %zu PI state %f %f", k, b->rate, b->integral);
+   }
+   salf_ckpt_close(&ckpt);
+   salf_strategy_set_free(&restored);
+
+   // file of other program is not used
+   fd = open(path, O_WRONLY | O_TRUNC);
+   memset(v1, 0x5a, sizeof(v1));
+   CHECK(fd >= 0 && write(fd, v1, sizeof(v1)) == (ssize_t)sizeof(v1), "write %s", path);
+   close(fd);
+   CHECK(salf_ckpt_open(&ckpt, path, 1, 2) == 0, "open foreign file");
+   CHECK(ckpt.old == NULL, "foreign file restored");
+   salf_ckpt_close(&ckpt);
+
+   salf_strategy_set_free(&set);
+   test_batch_free(tb);
+   free(tb);
+   unlink(path);
+   return TEST_RESULT();
+}
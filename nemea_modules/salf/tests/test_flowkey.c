@@ -0,0 +1,145 @@
+/*!
+ * \file test_flowkey.c
+ * \brief Unit tests of flow keys and their fallbacks for missing fields
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "test.h"
+#include "flowkey.h"
+
+#define FLOW_BATCHES 400 /*< Number of batches of budget check. */
+
+/*!
+ * \brief Swap source and destination endpoint of record.
+ * \param[in,out] r Record.
+ */
+static void flow_reverse(test_rec_t *r)
+{
+   ip_addr_t ip = r->src_ip;
+   uint16_t port = r->src_port;
+
+   r->src_ip = r->dst_ip;
+   r->dst_ip = ip;
+   r->src_port = r->dst_port;
+   r->dst_port = port;
+}
+
+int main(int argc, char **argv)
+{
+   salf_params_t params = SALF_PARAMS_DEFAULT;
+   salf_strategy_set_t set;
+   salf_view_t view;
+   test_batch_t *tb = malloc(sizeof(*tb));
+   test_rec_t a, b;
+   rng_t rng;
+   size_t selected = 0;
+   double rate;
+   size_t i;
+
+   (void)argc;
+   (void)argv;
+   probas_init();
+   fvec_init();
+   rng_init();
+   if (tb == NULL || test_batch_init(tb, 1)) {
+      fprintf(stderr, "Error: test setup failed.\n");
+      return EXIT_FAILURE;
+   }
+   rng_seed(&rng, 11, 0);
+   test_rec_random(&rng, &a, 1000000);
+   view = tb->batch.view;
+
+   // both directions of session share the key unless it is one-way
+   b = a;
+   flow_reverse(&b);
+   CHECK(salf_flowkey_fields(&view, SALF_KEY_DEFAULT) == SALF_KEY_DEFAULT, "fields %u", salf_flowkey_fields(&view, SALF_KEY_DEFAULT));
+   CHECK(salf_flowhash(&a, &view, SALF_KEY_DEFAULT, 0) == salf_flowhash(&b, &view, SALF_KEY_DEFAULT, 0), "directions differ");
+   CHECK(salf_flowhash(&a, &view, SALF_KEY_DEFAULT, 1) != salf_flowhash(&b, &view, SALF_KEY_DEFAULT, 1), "one-way directions equal");
+   b = a;
+   b.bytes++;
+   b.p[0] = 1;
+   CHECK(salf_flowhash(&a, &view, SALF_KEY_DEFAULT, 0) == salf_flowhash(&b, &view, SALF_KEY_DEFAULT, 0), "fields out of key change hash");
+   b = a;
+   b.protocol++;
+   CHECK(salf_flowhash(&a, &view, SALF_KEY_DEFAULT, 0) != salf_flowhash(&b, &view, SALF_KEY_DEFAULT, 0), "protocol not in key");
+   CHECK(salf_flowhash(&a, &view, SALF_KEY_SRC_IP | SALF_KEY_DST_IP, 0) == salf_flowhash(&b, &view, SALF_KEY_SRC_IP | SALF_KEY_DST_IP, 0), "protocol out of mask in key");
+
+   // missing fields are left out of key
+   view.SRC_PORT = UR_VIEW_NO_FIELD;
+   view.PROTOCOL = UR_VIEW_NO_FIELD;
+   CHECK(salf_flowkey_fields(&view, SALF_KEY_DEFAULT) == (SALF_KEY_SRC_IP | SALF_KEY_DST_IP | SALF_KEY_DST_PORT), "fields %u", salf_flowkey_fields(&view, SALF_KEY_DEFAULT));
+   CHECK(salf_flowkey_fields(&view, SALF_KEY_SRC_PORT | SALF_KEY_PROTOCOL) == 0, "fields %u", salf_flowkey_fields(&view, SALF_KEY_SRC_PORT | SALF_KEY_PROTOCOL));
+   b = a;
+   b.src_port++;
+   CHECK(salf_flowhash(&a, &view, SALF_KEY_DEFAULT, 0) == salf_flowhash(&b, &view, SALF_KEY_DEFAULT, 0), "missing SRC_PORT changes hash");
+   b = a;
+   b.dst_ip.ui64[1]++;
+   CHECK(salf_flowhash(&a, &view, SALF_KEY_DEFAULT, 0) != salf_flowhash(&b, &view, SALF_KEY_DEFAULT, 0), "DST_IP not in key");
+
+   // flow hash without any field of its key is rejected, partial key is used
+   params.query_strategy = SALF_Q_HASH;
+   params.hash_key = SALF_KEY_SRC_PORT | SALF_KEY_PROTOCOL;
+   CHECK(salf_params_check_view(&params, &view) != 0, "flow hash without key fields accepted");
+   params.hash_key = SALF_KEY_DEFAULT;
+   CHECK(salf_params_check_view(&params, &view) == 0, "flow hash with partial key rejected");
+   view.SRC_IP = UR_VIEW_NO_FIELD;
+   view.DST_IP = UR_VIEW_NO_FIELD;
+   view.DST_PORT = UR_VIEW_NO_FIELD;
+   CHECK(salf_params_check_view(&params, &view) != 0, "flow hash without key fields accepted");
+   params.query_strategy = SALF_Q_VARIABLE;
+   CHECK(salf_params_check_view(&params, &view) == 0, "strategy without key rejected");
+
+   // partial key keeps the budget
+   params.query_strategy = SALF_Q_HASH;
+   params.budget = 0.05;
+   tb->batch.view.SRC_PORT = UR_VIEW_NO_FIELD;
+   tb->batch.view.PROTOCOL = UR_VIEW_NO_FIELD;
+   CHECK(salf_strategy_set_init(&set, &params, 1, 1, 0) == 0, "set init");
+   for (i = 0; i < FLOW_BATCHES; i++) {
+      test_batch_fill(tb, &rng, TEST_BATCH, 1000000, i * 1000000ULL);
+      selected += salf_strategy_set_batch(&set, &tb->batch);
+   }
+   salf_strategy_set_free(&set);
+   rate = (double)selected / (FLOW_BATCHES * TEST_BATCH);
+   CHECK(rate > 0.8 * params.budget && rate < 1.2 * params.budget, "partial key labeled %.4f of flows", rate);
+
+   test_batch_free(tb);
+   free(tb);
+   return TEST_RESULT();
+}
@@ -0,0 +1,157 @@
+/*!
+ * \file test_hosts.c
+ * \brief Unit tests of Space-Saving counters and per-host label cap
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "test.h"
+#include "hosts.h"
+
+#define HOSTS_KEYS 4096 /*< Number of distinct hosts of skewed stream. */
+#define HOSTS_LABELS 200000 /*< Number of labels of skewed stream. */
+#define HOSTS_BATCHES 400 /*< Number of batches of cap check. */
+
+/*!
+ * \brief Check heap order and lookup table of counters.
+ * \param[in] hs Counters.
+ * \return 0 if consistent.
+ */
+static int hosts_consistent(const salf_hosts_t *hs)
+{
+   size_t i;
+
+   for (i = 0; i < hs->cnt; i++) {
+      const salf_host_t *h = &hs->heap[i];
+      if (i > 0 && hs->heap[(i - 1) / 2].count > h->count) {
+         return 1;
+      }
+      if (hs->table[h->slot] != (int16_t)i || salf_hosts_find(hs, h->key) != (size_t)h->slot) {
+         return 1;
+      }
+   }
+   return 0;
+}
+
+int main(int argc, char **argv)
+{
+   salf_params_t params = SALF_PARAMS_DEFAULT;
+   salf_strategy_set_t set;
+   salf_hosts_t *hs = malloc(sizeof(*hs));
+   test_batch_t *tb = malloc(sizeof(*tb));
+   uint32_t *cnt = calloc(HOSTS_KEYS, sizeof(*cnt));
+   rng_t rng;
+   size_t labels = 0;
+   size_t heavy = 0;
+   size_t under = 0;
+   size_t missed = 0;
+   size_t i, j;
+
+   (void)argc;
+   (void)argv;
+   probas_init();
+   fvec_init();
+   rng_init();
+   if (hs == NULL || tb == NULL || cnt == NULL || test_batch_init(tb, 1)) {
+      fprintf(stderr, "Error: test setup failed.\n");
+      return EXIT_FAILURE;
+   }
+   rng_seed(&rng, 17, 0);
+
+   // counts are exact while hosts fit into counters
+   salf_hosts_init(hs);
+   for (i = 0; i < SALF_HOSTS_MAX; i++) {
+      for (j = 0; j <= i % 7; j++) {
+         salf_hosts_add(hs, 0x9e3779b97f4a7c15ULL * (i + 1));
+      }
+   }
+   for (i = 0; i < SALF_HOSTS_MAX; i++) {
+      uint32_t c = salf_hosts_get(hs, 0x9e3779b97f4a7c15ULL * (i + 1));
+      CHECK(c == i % 7 + 1, "host %zu count %u", i, c);
+   }
+   CHECK(salf_hosts_get(hs, 1) == 0, "unmonitored host counted");
+   CHECK(hosts_consistent(hs) == 0, "counters inconsistent");
+
+   // skewed stream: frequent hosts stay monitored and are never undercounted
+   salf_hosts_init(hs);
+   for (i = 0; i < HOSTS_LABELS; i++) {
+      // roughly Zipf distributed host
+      size_t k = (size_t)(HOSTS_KEYS * rng_uniform(&rng) * rng_uniform(&rng) * rng_uniform(&rng));
+      salf_hosts_add(hs, 0x9e3779b97f4a7c15ULL * (k + 1));
+      cnt[k]++;
+   }
+   CHECK(hosts_consistent(hs) == 0, "counters inconsistent");
+   CHECK(hs->labels == HOSTS_LABELS, "%u labels counted", hs->labels);
+   for (i = 0; i < HOSTS_KEYS; i++) {
+      uint32_t c = salf_hosts_get(hs, 0x9e3779b97f4a7c15ULL * (i + 1));
+      missed += c == 0 && cnt[i] > HOSTS_LABELS / SALF_HOSTS_MAX;
+      under += c != 0 && c < cnt[i];
+   }
+   CHECK(missed == 0, "%zu frequent hosts not monitored", missed);
+   CHECK(under == 0, "%zu hosts undercounted", under);
+   for (i = 0; i < hs->cnt; i++) {
+      const salf_host_t *h = &hs->heap[i];
+      CHECK(h->count >= h->error, "count %u below error %u", h->count, h->error);
+   }
+
+   // host sending half of flows gets at most its share of labels
+   params.query_strategy = SALF_Q_RANDOM;
+   params.budget = 0.2;
+   params.host_share = 0.1;
+   params.host_window = 1000;
+   CHECK(salf_strategy_set_init(&set, &params, 1, 1, 0) == 0, "set init");
+   for (i = 0; i < HOSTS_BATCHES; i++) {
+      test_batch_fill(tb, &rng, TEST_BATCH, 1 << 20, i * 1000000ULL);
+      for (j = 0; j < TEST_BATCH; j += 2) {
+         tb->rec[j].src_ip.ui64[1] = 0x0b000001;
+      }
+      labels += salf_strategy_set_batch(&set, &tb->batch);
+      for (j = 0; j < TEST_BATCH; j += 2) {
+         heavy += tb->decision[j] != 0;
+      }
+   }
+   salf_strategy_set_free(&set);
+   CHECK(labels > 0 && heavy <= (labels / params.host_window + 1) * params.host_share * params.host_window, "heavy host got %zu of %zu labels", heavy, labels);
+   CHECK(heavy >= 0.09 * labels, "heavy host got %zu of %zu labels", heavy, labels);
+
+   test_batch_free(tb);
+   free(tb);
+   free(hs);
+   free(cnt);
+   return TEST_RESULT();
+}
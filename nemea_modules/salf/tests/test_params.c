@@ -0,0 +1,159 @@
+/*!
+ * \file test_params.c
+ * \brief Unit tests of parsing and validation of strategy configurations
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <unistd.h>
+#include "test.h"
+#include "flowkey.h"
+
+int main(int argc, char **argv)
+{
+   static const char *invalid[] = {
+      "q", "q=", "q=x", "q=1;b=0.1", "b=0.1x", "z=1", "=1", "q=1,,b=0.1", "Q=1",
+   };
+   char path[] = "/tmp/salf_params_XXXXXX";
+   salf_params_t dflt = SALF_PARAMS_DEFAULT;
+   salf_params_t params = SALF_PARAMS_DEFAULT;
+   salf_params_t loaded[3];
+   size_t cnt;
+   size_t i;
+   FILE *fp;
+   int fd;
+
+   (void)argc;
+   (void)argv;
+
+   // every key sets its parameter
+   CHECK(salf_params_parse(&params, "q=4,b=0.25,t=0.7,s=0.05,d=2.5,r=100,R=10,a=1,g=0.3,G=0.02,W=500,e=1,y=2,"
+      "k=7,n=300,i=1.5,x=0x5,o=1,u=3,l=30,h=0.2,j=2000,L=4,T=60,C=16") == 0, "all keys rejected");
+   CHECK(params.query_strategy == 4 && params.budget == 0.25 && params.labeling_threshold == 0.7, "q, b, t");
+   CHECK(params.step == 0.05 && params.t_deviation == 2.5, "s, d");
+   CHECK(params.rate == 100 && params.burst == 10 && params.auto_threshold == 1, "r, R, a");
+   CHECK(params.kp == 0.3 && params.ki == 0.02 && params.window == 500, "g, G, W");
+   CHECK(params.committee_measure == 1 && params.stratify == 2, "e, y");
+   CHECK(params.select_k == 7 && params.select_window == 300 && params.select_interval == 1.5, "k, n, i");
+   CHECK(params.hash_key == (SALF_KEY_SRC_IP | SALF_KEY_SRC_PORT) && params.hash_oneway == 1, "x, o");
+   CHECK(params.dedup == 3 && params.dedup_halflife == 30, "u, l");
+   CHECK(params.host_share == 0.2 && params.host_window == 2000, "h, j");
+   CHECK(params.lsh_bands == 4 && params.lsh_ttl == 60 && params.clusters == 16, "L, T, C");
+
+   // keys not given keep their values
+   params = dflt;
+   CHECK(salf_params_parse(&params, "b=0.1") == 0, "budget rejected");
+   CHECK(params.budget == 0.1, "budget %f", params.budget);
+   CHECK(params.query_strategy == dflt.query_strategy && params.labeling_threshold == dflt.labeling_threshold, "q, t changed");
+   CHECK(params.select_window == dflt.select_window && params.hash_key == dflt.hash_key && params.clusters == dflt.clusters, "n, x, C changed");
+   CHECK(salf_params_parse(&params, "") == 0, "empty configuration rejected");
+
+   // malformed configurations are rejected
+   for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+      params = dflt;
+      CHECK(salf_params_parse(&params, invalid[i]) != 0, "'%s' accepted", invalid[i]);
+   }
+
+   // file holds one configuration per line, comments and empty lines skipped
+   fd = mkstemp(path);
+   fp = fd >= 0 ? fdopen(fd, "w") : NULL;
+   if (fp == NULL) {
+      fprintf(stderr, "Error: test setup failed.\n");
+      return EXIT_FAILURE;
+   }
+   fprintf(fp, "# strategies\nq=0,b=0.1\n\nq=2\r\nq=10,x=3 trailing comment\n");
+   fclose(fp);
+   for (i = 0; i < 3; i++) {
+      loaded[i] = dflt;
+   }
+   CHECK(salf_params_load(path, loaded, 3, &cnt) == 0 && cnt == 3, "loaded %zu configurations", cnt);
+   CHECK(loaded[0].query_strategy == 0 && loaded[0].budget == 0.1, "line 2");
+   CHECK(loaded[1].query_strategy == 2 && loaded[1].budget == dflt.budget, "line 4");
+   CHECK(loaded[2].query_strategy == 10 && loaded[2].hash_key == 3, "line 5");
+   CHECK(salf_params_load(path, loaded, 2, &cnt) != 0, "more configurations than max accepted");
+   fp = fopen(path, "a");
+   CHECK(fp != NULL, "reopen %s", path);
+   if (fp != NULL) {
+      fprintf(fp, "q=1,b\n");
+      fclose(fp);
+   }
+   CHECK(salf_params_load(path, loaded, 3, &cnt) != 0, "invalid line accepted");
+   unlink(path);
+   CHECK(salf_params_load(path, loaded, 3, &cnt) != 0 && cnt == 0, "missing file accepted");
+
+   // configurations needing fields or settings not given are rejected
+   params = dflt;
+   CHECK(salf_params_validate(&params, 1, 0) == 0, "default rejected");
+   params.query_strategy = SALF_Q_COMMITTEE;
+   CHECK(salf_params_validate(&params, 1, 0) != 0, "committee of 1 accepted");
+   CHECK(salf_params_validate(&params, 2, 0) == 0, "committee of 2 rejected");
+   params = dflt;
+   params.lsh_bands = 3;
+   CHECK(salf_params_validate(&params, 1, 3) != 0, "3 bands accepted");
+   params.lsh_bands = 4;
+   CHECK(salf_params_validate(&params, 1, 0) != 0, "bands without features accepted");
+   CHECK(salf_params_validate(&params, 1, 3) == 0, "4 bands rejected");
+   params.lsh_ttl = -1;
+   CHECK(salf_params_validate(&params, 1, 3) != 0, "negative TTL accepted");
+   params = dflt;
+   params.query_strategy = SALF_Q_DIVERSITY;
+   CHECK(salf_params_validate(&params, 1, 0) != 0, "diversity without features accepted");
+   params.clusters = SALF_CLUSTERS_MAX + 1;
+   CHECK(salf_params_validate(&params, 1, 3) != 0, "%u clusters accepted", params.clusters);
+   params.clusters = dflt.clusters;
+   CHECK(salf_params_validate(&params, 1, 3) == 0, "diversity rejected");
+
+   // time windows need explicit k and interval
+   for (i = 0; i < 2; i++) {
+      params = dflt;
+      params.query_strategy = i == 0 ? SALF_Q_TOPK : SALF_Q_RESERVOIR;
+      params.select_window = 0;
+      params.select_k = 0;
+      params.select_interval = 1;
+      CHECK(salf_params_validate(&params, 1, 0) != 0, "q=%d time window without k accepted", params.query_strategy);
+      params.select_k = 10;
+      CHECK(salf_params_validate(&params, 1, 0) == 0, "q=%d time window with k rejected", params.query_strategy);
+      params.select_interval = 0;
+      CHECK(salf_params_validate(&params, 1, 0) != 0, "q=%d time window of 0 s accepted", params.query_strategy);
+      params.select_window = 1000;
+      params.select_k = 0;
+      CHECK(salf_params_validate(&params, 1, 0) == 0, "q=%d count window rejected", params.query_strategy);
+   }
+
+   return TEST_RESULT();
+}
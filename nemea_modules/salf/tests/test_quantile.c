@@ -0,0 +1,103 @@
+/*!
+ * \file test_quantile.c
+ * \brief Unit tests of streaming quantile estimation
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <math.h>
+#include "test.h"
+#include "quantile.h"
+
+#define QUANTILE_OBS 1000000 /*< Number of observations per phase of stream. */
+
+int main(int argc, char **argv)
+{
+   static const double ps[] = {0.05, 0.5, 0.9, 0.99};
+   p2_t e, whole;
+   rng_t rng;
+   double est;
+   size_t i, k;
+
+   (void)argc;
+   (void)argv;
+   rng_init();
+   rng_seed(&rng, 19, 0);
+
+   // default until five observations are seen
+   p2_init(&e, 0.5, 0);
+   CHECK(p2_get(&e, -1) == -1, "estimate %f of empty stream", p2_get(&e, -1));
+   for (i = 0; i < 4; i++) {
+      p2_add(&e, (double)i);
+   }
+   CHECK(p2_get(&e, -1) == -1, "estimate %f of 4 observations", p2_get(&e, -1));
+   p2_add(&e, 4);
+   CHECK(p2_get(&e, -1) == 2, "median %f of 0..4", p2_get(&e, -1));
+
+   // quantiles of uniform and exponential distribution
+   for (k = 0; k < sizeof(ps) / sizeof(ps[0]); k++) {
+      p2_init(&e, ps[k], SALF_QUANTILE_WINDOW);
+      for (i = 0; i < QUANTILE_OBS; i++) {
+         p2_add(&e, rng_uniform(&rng));
+      }
+      est = p2_get(&e, 0);
+      CHECK(fabs(est - ps[k]) < 0.02, "uniform %.2f-quantile %f", ps[k], est);
+
+      p2_init(&e, ps[k], SALF_QUANTILE_WINDOW);
+      for (i = 0; i < QUANTILE_OBS; i++) {
+         p2_add(&e, -log(rng_uniform_pos(&rng)));
+      }
+      est = p2_get(&e, 0);
+      CHECK(fabs(est + log(1 - ps[k])) < 0.05 * (1 - log(1 - ps[k])), "exponential %.2f-quantile %f, exact %f", ps[k], est, -log(1 - ps[k]));
+   }
+
+   // forget window follows shift of distribution, whole history does not
+   p2_init(&e, 0.9, SALF_QUANTILE_WINDOW);
+   p2_init(&whole, 0.9, 0);
+   for (i = 0; i < 2 * QUANTILE_OBS; i++) {
+      double x = rng_uniform(&rng) * (i < QUANTILE_OBS ? 1.0 : 0.1);
+      p2_add(&e, x);
+      p2_add(&whole, x);
+   }
+   est = p2_get(&e, 0);
+   CHECK(fabs(est - 0.09) < 0.005, "0.9-quantile %f after shift, exact 0.09", est);
+   est = p2_get(&whole, 0);
+   CHECK(fabs(est - 0.8) < 0.02, "0.9-quantile %f of whole history, exact 0.8", est);
+
+   return TEST_RESULT();
+}
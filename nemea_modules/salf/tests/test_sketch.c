@@ -0,0 +1,166 @@
+/*!
+ * \file test_sketch.c
+ * \brief Unit tests of count-min sketch and dedup of endpoint pairs
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "test.h"
+#include "sketch.h"
+
+#define SKETCH_KEYS 4000 /*< Number of distinct keys counted. */
+#define DEDUP_BATCHES 200 /*< Number of batches of dedup checks. */
+
+/*!
+ * \brief Run strategy over synthetic stream.
+ * \param[in] params Parameters.
+ * \param[in] view View of records.
+ * \param[in] flows Number of distinct flow keys.
+ * \return Number of labeled flows.
+ */
+static size_t dedup_run(const salf_params_t *params, const salf_view_t *view, uint64_t flows)
+{
+   salf_strategy_set_t set;
+   test_batch_t *tb = malloc(sizeof(*tb));
+   rng_t rng;
+   size_t selected = 0;
+   size_t i;
+
+   if (tb == NULL || test_batch_init(tb, 1) || salf_strategy_set_init(&set, params, 1, 1, 0)) {
+      free(tb);
+      return 0;
+   }
+   rng_seed(&rng, 5, 0);
+   tb->batch.view = *view;
+   for (i = 0; i < DEDUP_BATCHES; i++) {
+      test_batch_fill(tb, &rng, TEST_BATCH, flows, i * 1000000ULL);
+      selected += salf_strategy_set_batch(&set, &tb->batch);
+   }
+   salf_strategy_set_free(&set);
+   test_batch_free(tb);
+   free(tb);
+   return selected;
+}
+
+int main(int argc, char **argv)
+{
+   salf_params_t params = SALF_PARAMS_DEFAULT;
+   salf_sketch_t sk;
+   salf_view_t view;
+   test_batch_t *tb = malloc(sizeof(*tb));
+   rng_t rng;
+   uint64_t *key = malloc(SKETCH_KEYS * sizeof(*key));
+   unsigned int *cnt = malloc(SKETCH_KEYS * sizeof(*cnt));
+   size_t over = 0;
+   size_t under = 0;
+   size_t labeled;
+   size_t i;
+
+   (void)argc;
+   (void)argv;
+   probas_init();
+   fvec_init();
+   rng_init();
+   if (tb == NULL || key == NULL || cnt == NULL || test_batch_init(tb, 1) || salf_sketch_alloc(&sk, 0)) {
+      fprintf(stderr, "Error: test setup failed.\n");
+      return EXIT_FAILURE;
+   }
+   view = tb->batch.view;
+   test_batch_free(tb);
+   free(tb);
+   rng_seed(&rng, 13, 0);
+
+   // estimate never undercounts, overcounts rarely while keys are fewer than counters of row
+   for (i = 0; i < SKETCH_KEYS; i++) {
+      key[i] = rng_u64(&rng);
+      cnt[i] = 0;
+   }
+   for (i = 0; i < 4 * SKETCH_KEYS; i++) {
+      size_t k = (size_t)rng_below(&rng, SKETCH_KEYS);
+      salf_sketch_add(&sk, key[k]);
+      cnt[k]++;
+   }
+   for (i = 0; i < SKETCH_KEYS; i++) {
+      unsigned int est = salf_sketch_get(&sk, key[i]);
+      under += est < cnt[i];
+      over += est > cnt[i];
+   }
+   CHECK(under == 0, "%zu of %d keys undercounted", under, SKETCH_KEYS);
+   CHECK(over < SKETCH_KEYS / 100, "%zu of %d keys overcounted", over, SKETCH_KEYS);
+
+   // counters are halved once per half-life
+   salf_sketch_free(&sk);
+   salf_sketch_alloc(&sk, 0);
+   for (i = 0; i < 100; i++) {
+      salf_sketch_add(&sk, key[0]);
+   }
+   salf_sketch_decay(&sk, 999, 1000);
+   CHECK(salf_sketch_get(&sk, key[0]) == 100, "count %u before half-life", salf_sketch_get(&sk, key[0]));
+   salf_sketch_decay(&sk, 1000, 1000);
+   CHECK(salf_sketch_get(&sk, key[0]) == 50, "count %u after half-life", salf_sketch_get(&sk, key[0]));
+   salf_sketch_decay(&sk, 3500, 1000);
+   CHECK(salf_sketch_get(&sk, key[0]) == 12, "count %u after 3 half-lives", salf_sketch_get(&sk, key[0]));
+   salf_sketch_decay(&sk, 1000000, 1000);
+   CHECK(salf_sketch_get(&sk, key[0]) == 0, "count %u after 1000 half-lives", salf_sketch_get(&sk, key[0]));
+   salf_sketch_decay(&sk, 1000000000, 0);
+   CHECK(sk.ts == 1000000, "decay without half-life moved time to %lu", (unsigned long)sk.ts);
+   salf_sketch_free(&sk);
+
+   // each of 4 endpoint pairs is labeled at most once within half-life
+   params.query_strategy = SALF_Q_RANDOM;
+   params.budget = 0.5;
+   params.dedup = 1;
+   CHECK(salf_params_check_view(&params, &view) == 0, "dedup with pair fields rejected");
+   labeled = dedup_run(&params, &view, 4);
+   CHECK(labeled >= 1 && labeled <= 4, "%zu labels of 4 endpoint pairs", labeled);
+
+   // dedup is rejected without fields of pair and not applied by strategy
+   view.DST_PORT = UR_VIEW_NO_FIELD;
+   CHECK(salf_params_check_view(&params, &view) != 0, "dedup without DST_PORT accepted");
+   labeled = dedup_run(&params, &view, 4);
+   CHECK(labeled > 0.4 * DEDUP_BATCHES * TEST_BATCH, "%zu labels of %d flows without dedup", labeled, DEDUP_BATCHES * TEST_BATCH);
+   params.query_strategy = SALF_Q_TOPK;
+   CHECK(salf_params_check_view(&params, &view) == 0, "missing DST_PORT with window strategy rejected");
+   params.query_strategy = SALF_Q_RANDOM;
+   params.dedup = 0;
+   CHECK(salf_params_check_view(&params, &view) == 0, "missing DST_PORT without dedup rejected");
+
+   free(key);
+   free(cnt);
+   return TEST_RESULT();
+}
@@ -0,0 +1,121 @@
+/*!
+ * \file test_spsc.c
+ * \brief Unit tests of single producer single consumer ring
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include "test.h"
+#include "spsc.h"
+
+#define SPSC_TEST_CAPACITY 8 /*< Capacity of tested ring. */
+#define SPSC_TEST_ITEMS 200000 /*< Number of pointers passed between threads. */
+
+/*!
+ * \brief Push sequence 1..SPSC_TEST_ITEMS, yielding while ring is full.
+ * \param[in] arg Ring.
+ * \return NULL.
+ */
+static void *producer(void *arg)
+{
+   spsc_t *q = arg;
+   uintptr_t i;
+
+   for (i = 1; i <= SPSC_TEST_ITEMS; i++) {
+      while (spsc_push(q, (void *)i)) {
+         sched_yield();
+      }
+   }
+   return NULL;
+}
+
+int main(int argc, char **argv)
+{
+   void *slot[SPSC_TEST_CAPACITY];
+   spsc_t q;
+   pthread_t thread;
+   uintptr_t expected = 1;
+   uintptr_t i;
+   size_t out_of_order = 0;
+
+   (void)argc;
+   (void)argv;
+
+   // ring holds capacity pointers in FIFO order
+   spsc_init(&q, slot, SPSC_TEST_CAPACITY);
+   CHECK(spsc_pop(&q) == NULL, "empty ring popped");
+   for (i = 1; i <= SPSC_TEST_CAPACITY; i++) {
+      CHECK(spsc_push(&q, (void *)i) == 0, "push %lu to ring of %d failed", (unsigned long)i, SPSC_TEST_CAPACITY);
+   }
+   CHECK(spsc_push(&q, (void *)i) == 1, "full ring accepted push");
+   for (i = 1; i <= SPSC_TEST_CAPACITY; i++) {
+      void *p = spsc_pop(&q);
+      CHECK(p == (void *)i, "popped %p, pushed %lu", p, (unsigned long)i);
+   }
+   CHECK(spsc_pop(&q) == NULL, "empty ring popped");
+
+   // indices wrap around the storage
+   for (i = 1; i <= 3 * SPSC_TEST_CAPACITY + 1; i++) {
+      CHECK(spsc_push(&q, (void *)i) == 0, "push %lu failed", (unsigned long)i);
+      CHECK(spsc_pop(&q) == (void *)i, "pop %lu failed", (unsigned long)i);
+   }
+
+   // pointers cross threads in order, none lost or duplicated
+   spsc_init(&q, slot, SPSC_TEST_CAPACITY);
+   if (pthread_create(&thread, NULL, producer, &q) != 0) {
+      fprintf(stderr, "Error: pthread_create failed.\n");
+      return EXIT_FAILURE;
+   }
+   while (expected <= SPSC_TEST_ITEMS) {
+      void *p = spsc_pop(&q);
+      if (p == NULL) {
+         sched_yield();
+         continue;
+      }
+      out_of_order += p != (void *)expected;
+      expected = (uintptr_t)p + 1;
+   }
+   pthread_join(thread, NULL);
+   CHECK(out_of_order == 0, "%zu pointers out of order", out_of_order);
+   CHECK(spsc_pop(&q) == NULL, "extra pointer in ring");
+
+   return TEST_RESULT();
+}
@@ -0,0 +1,228 @@
+/*!
+ * \file test_strategy.c
+ * \brief Unit tests of selection rates of query strategies
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "test.h"
+
+#define RATE_BATCHES 800 /*< Number of batches per strategy. */
+#define RATE_BUDGET 0.05 /*< Budget of strategies. */
+#define RATE_SECONDS (RATE_BATCHES / 10) /*< Duration of stream of 100 ms batches in seconds. */
+
+/*!
+ * \brief Run strategy over synthetic stream as one of workers.
+ * \param[in] params Parameters.
+ * \param[in] throttle Fraction of flows offered to strategy.
+ * \param[in] flows Number of distinct flow keys.
+ * \param[in] share Fraction of rate budget of instance.
+ * \param[in] step Time between batches in ns.
+ * \return Number of labeled flows, negative on allocation failure.
+ */
+static double rate_run_share(const salf_params_t *params, double throttle, uint64_t flows, double share, uint64_t step)
+{
+   salf_strategy_set_t set;
+   test_batch_t *tb = malloc(sizeof(*tb));
+   rng_t rng;
+   size_t selected = 0;
+   size_t i;
+
+   if (tb == NULL || test_batch_init(tb, 1) || salf_strategy_set_init(&set, params, 1, 1, 0)) {
+      free(tb);
+      return -1;
+   }
+   salf_strategy_set_share(&set, share);
+   rng_seed(&rng, 7, 0);
+   tb->batch.throttle = throttle;
+   for (i = 0; i < RATE_BATCHES; i++) {
+      test_batch_fill(tb, &rng, TEST_BATCH, flows, i * step);
+      tb->batch.flush = i + 1 == RATE_BATCHES;
+      selected += salf_strategy_set_batch(&set, &tb->batch);
+   }
+   salf_strategy_set_free(&set);
+   test_batch_free(tb);
+   free(tb);
+   return (double)selected;
+}
+
+/*!
+ * \brief Run strategy over synthetic stream of 1 ms batches.
+ * \param[in] params Parameters.
+ * \param[in] throttle Fraction of flows offered to strategy.
+ * \param[in] flows Number of distinct flow keys.
+ * \return Fraction of labeled flows, negative on allocation failure.
+ */
+static double rate_run(const salf_params_t *params, double throttle, uint64_t flows)
+{
+   return rate_run_share(params, throttle, flows, 1.0, 1000000) / (RATE_BATCHES * TEST_BATCH);
+}
+
+/*!
+ * \brief Reload windowed strategy to variable uncertainty in the middle of window.
+ * \param[in] params Parameters of windowed strategy, select_window above TEST_BATCH.
+ * \param[out] held Number of records seen by the open window before reload.
+ * \return Number of records released with the batch of reload, negative on allocation failure.
+ */
+static double reload_run(const salf_params_t *params, uint64_t *held)
+{
+   salf_strategy_set_t set;
+   salf_params_t reload = *params;
+   test_batch_t *tb = malloc(sizeof(*tb));
+   rng_t rng;
+   double released;
+
+   if (tb == NULL || test_batch_init(tb, 1) || salf_strategy_set_init(&set, params, 1, 1, 0)) {
+      free(tb);
+      return -1;
+   }
+   rng_seed(&rng, 7, 0);
+   test_batch_fill(tb, &rng, TEST_BATCH, 1000000, 0);
+   salf_strategy_set_batch(&set, &tb->batch);
+   *held = set.strategy[0].state.hold.seen;
+
+   reload.query_strategy = SALF_Q_VARIABLE;
+   tb->batch.params = &reload;
+   tb->batch.params_gen = 1;
+   test_batch_fill(tb, &rng, TEST_BATCH, 1000000, 1000000);
+   salf_strategy_set_batch(&set, &tb->batch);
+   released = set.strategy[0].state.hold.seen == 0 ? (double)tb->batch.release.cnt : -1;
+   salf_strategy_set_free(&set);
+   test_batch_free(tb);
+   free(tb);
+   return released;
+}
+
+int main(int argc, char **argv)
+{
+   salf_params_t params = SALF_PARAMS_DEFAULT;
+   double rate;
+   double labels;
+   double min;
+   int q;
+
+   (void)argc;
+   (void)argv;
+
+   probas_init();
+   fvec_init();
+   rng_init();
+
+   params.budget = RATE_BUDGET;
+   params.labeling_threshold = 0.5;
+   params.step = 0.01;
+   params.select_window = 1000;
+   // every strategy keeps the budget, fixed uncertainty with auto threshold
+   for (q = SALF_Q_RANDOM; q <= SALF_Q_DIVERSITY; q++) {
+      params.query_strategy = q;
+      params.auto_threshold = q == SALF_Q_FIXED;
+      rate = rate_run(&params, 1.0, 1000000);
+      CHECK(rate > 0.8 * RATE_BUDGET && rate < 1.1 * RATE_BUDGET, "q=%d labeled %.4f of flows, budget %.2f", q, rate, RATE_BUDGET);
+   }
+   params.auto_threshold = 0;
+
+   // fixed threshold is not adapted
+   params.query_strategy = SALF_Q_FIXED;
+   params.labeling_threshold = 0;
+   rate = rate_run(&params, 1.0, 1000000);
+   CHECK(rate == 0, "threshold 0 labeled %.4f of flows", rate);
+   params.labeling_threshold = 0.5;
+
+   // under backpressure the budget applies to offered flows
+   params.query_strategy = SALF_Q_VARIABLE;
+   rate = rate_run(&params, 0.5, 1000000);
+   CHECK(rate > 0.4 * RATE_BUDGET && rate < 0.55 * RATE_BUDGET, "throttle 0.5 labeled %.4f of flows", rate);
+
+   // rate budget of 1000 labels/s allows one label per 1 ms batch
+   params.rate = 1000;
+   params.burst = 1;
+   for (q = SALF_Q_RANDOM; q <= SALF_Q_DIVERSITY; q++) {
+      params.query_strategy = q;
+      rate = rate_run(&params, 1.0, 1000000);
+      // windowed strategies release at most the bucket of one token per window
+      min = salf_strategy_windowed(q) ? 0.5 / params.select_window : 0.5 / TEST_BATCH;
+      CHECK(rate <= 1.0 / TEST_BATCH + 1e-9 && rate >= min, "q=%d labeled %.4f of flows at 1 label per batch", q, rate);
+   }
+
+   // rates below one label per second (of instance) still label, 100 ms batches
+   params.burst = 0;
+   for (q = SALF_Q_RANDOM; q <= SALF_Q_DIVERSITY; q++) {
+      params.query_strategy = q;
+      params.rate = 0.5;
+      labels = rate_run_share(&params, 1.0, 1000000, 1.0, 100000000);
+      CHECK(labels >= 0.8 * RATE_SECONDS * 0.5 && labels <= RATE_SECONDS * 0.5 + 1, "q=%d labeled %.0f flows at 0.5 labels/s", q, labels);
+      // one of 4 workers of -r 2
+      params.rate = 2;
+      labels = rate_run_share(&params, 1.0, 1000000, 0.25, 100000000);
+      CHECK(labels >= 0.8 * RATE_SECONDS * 0.5 && labels <= RATE_SECONDS * 0.5 + 1, "q=%d worker labeled %.0f flows at 2 labels/s of 4 workers", q, labels);
+      // one of 4 workers of -r 0.5 -R 2
+      params.rate = 0.5;
+      params.burst = 2;
+      labels = rate_run_share(&params, 1.0, 1000000, 0.25, 100000000);
+      CHECK(labels >= 0.8 * RATE_SECONDS * 0.125 && labels <= RATE_SECONDS * 0.125 + 1, "q=%d worker labeled %.0f flows at 0.5 labels/s of 4 workers", q, labels);
+      params.burst = 0;
+   }
+   params.rate = 0;
+
+   // time windows of 100 ms select k records per window of all 4 workers
+   params.select_window = 0;
+   params.select_k = 8;
+   params.select_interval = 0.1;
+   for (q = SALF_Q_TOPK; q <= SALF_Q_RESERVOIR; q++) {
+      params.query_strategy = q;
+      labels = rate_run_share(&params, 1.0, 1000000, 0.25, 100000000);
+      CHECK(labels >= (RATE_BATCHES - 2) * 2 && labels <= RATE_BATCHES * 2, "q=%d worker labeled %.0f flows in %d windows of k 8 of 4 workers", q, labels, RATE_BATCHES);
+   }
+   params.select_window = 1000;
+   params.select_k = 0;
+   params.select_interval = SALF_SELECT_INTERVAL_DEFAULT;
+
+   // reload to a strategy without windows releases the open window
+   for (q = SALF_Q_TOPK; q <= SALF_Q_RESERVOIR; q++) {
+      uint64_t held = 0;
+      params.query_strategy = q;
+      labels = reload_run(&params, &held);
+      CHECK(held == TEST_BATCH && labels == ceil(params.budget * TEST_BATCH), "q=%d released %.0f of %" PRIu64 " held flows on reload", q, labels, held);
+   }
+
+   // all records of one flow share the decision of flow hash
+   params.query_strategy = SALF_Q_HASH;
+   rate = rate_run(&params, 1.0, 1);
+   CHECK(rate == 0 || rate == 1, "one flow labeled %.4f of records", rate);
+   return TEST_RESULT();
+}
@@ -0,0 +1,154 @@
+/*!
+ * \file window.h
+ * \brief Exact sliding-window counter of labeled flows
+ * \date 2026
+ */
+/*
+ * Copyright (C) 2026 CESNET
+ *
+ * LICENSE TERMS
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef _WINDOW_H_
+#define _WINDOW_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "salf.h"
+
+/*
+ * Decisions of the last size flows are kept in a ring of bits together with
+ * the number of set bits (labeled flows in the window). Pushing a decision
+ * replaces the oldest bit and updates the count, so the windowed label rate
+ * is exact and costs O(1) per flow. The ring of SALF_WINDOW_MAX bits takes
+ * SALF_WINDOW_MAX / 8 bytes.
+ */
+
+/*!
+ * \brief Sliding window of decisions.
+ */
+typedef struct salf_window_s {
+   uint64_t bits[SALF_WINDOW_MAX / 64]; /*< Ring of decisions. */
+   uint32_t size; /*< Number of flows in full window. */
+   uint32_t len; /*< Number of flows in window, up to size. */
+   uint32_t pos; /*< Position of the next decision. */
+   uint32_t cnt; /*< Number of labeled flows in window. */
+} salf_window_t;
+
+/*!
+ * \brief Initialize empty window.
+ * \param[out] w Window.
+ * \param[in] size Number of flows, 1 .. SALF_WINDOW_MAX (clamped).
+ */
+static inline void salf_window_init(salf_window_t *w, uint32_t size)
+{
+   if (size < 1) {
+      size = 1;
+   } else if (size > SALF_WINDOW_MAX) {
+      size = SALF_WINDOW_MAX;
+   }
+   memset(w->bits, 0, sizeof(w->bits));
+   w->size = size;
+   w->len = 0;
+   w->pos = 0;
+   w->cnt = 0;
+}
+
+/*!
+ * \brief Fill window with len decisions of which cnt are labels, spread evenly.
+ * Used to warm up window from saved counters.
+ * \param[in,out] w Window.
+ * \param[in] len Number of flows, window keeps the labeled fraction if len exceeds size.
+ * \param[in] cnt Number of labeled flows.
+ */
+static inline void salf_window_fill(salf_window_t *w, uint32_t len, uint32_t cnt)
+{
+   uint32_t i;
+   uint64_t acc = 0;
+
+   salf_window_init(w, w->size);
+   if (cnt > len) {
+      cnt = len;
+   }
+   if (len > w->size) {
+      cnt = (uint32_t)((uint64_t)cnt * w->size / len);
+      len = w->size;
+   }
+   for (i = 0; i < len; i++) {
+      acc += cnt;
+      if (acc >= len) {
+         acc -= len;
+         w->bits[i >> 6] |= 1ULL << (i & 63);
+      }
+   }
+   w->len = len;
+   w->cnt = cnt;
+   w->pos = len == w->size ? 0 : len;
+}
+
+/*!
+ * \brief Check whether labeling the next flow keeps window under budget.
+ * The next flow is counted into window (and the oldest one drops out of
+ * full window), as t is incremented before check of u/t in strategies.
+ * \param[in] w Window.
+ * \param[in] budget Max fraction of labeled flows.
+ * \return Nonzero if labeled fraction is below budget.
+ */
+static inline int salf_window_below(const salf_window_t *w, double budget)
+{
+   uint32_t n = w->len < w->size ? w->len + 1 : w->size;
+   return (double)w->cnt < budget * (double)n;
+}
+
+/*!
+ * \brief Append decision, the oldest one drops out of full window.
+ * \param[in,out] w Window.
+ * \param[in] label Decision (0 or 1).
+ */
+static inline void salf_window_push(salf_window_t *w, unsigned int label)
+{
+   uint64_t *word = &w->bits[w->pos >> 6];
+   uint64_t mask = 1ULL << (w->pos & 63);
+
+   // bits of positions which were not written yet are zero
+   w->cnt -= (*word & mask) != 0;
+   w->cnt += label;
+   *word = (*word & ~mask) | (-(uint64_t)label & mask);
+   if (++w->pos == w->size) {
+      w->pos = 0;
+   }
+   w->len += w->len < w->size;
+}
+
+#endif /* _WINDOW_H_ */